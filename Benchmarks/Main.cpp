@@ -0,0 +1,490 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 10:12:40pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include <cstdio>
+
+#include "../Source/PluginProcessor.h"
+
+//==============================================================================
+// Console benchmarks behind the numbers quoted for the DSP changes, built by
+// j13bench.jucer. Run with the name of one benchmark, or none for all of
+// them. Every run is single threaded; timings are ns per sample frame.
+
+static constexpr double sampleRate = 48000.0;
+
+// Steady clock nanoseconds since start
+static double nanosecondsSince(juce::int64 start)
+{
+	return (double)(juce::Time::getHighResolutionTicks() - start) * 1.0e9
+		/ (double)juce::Time::getHighResolutionTicksPerSecond();
+}
+
+// A mix of sines at -6 dBFS, the same on every run
+template <typename SampleType>
+static void fillTestSignal(juce::AudioBuffer<SampleType>& buffer, juce::int64 firstFrame)
+{
+	for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+		auto* data = buffer.getWritePointer(channel);
+
+		for (int i = 0; i < buffer.getNumSamples(); ++i) {
+			auto t = (double)(firstFrame + i) / sampleRate;
+			auto x = 0.3 * std::sin(juce::MathConstants<double>::twoPi * 110.0 * t + channel)
+				+ 0.2 * std::sin(juce::MathConstants<double>::twoPi * 1760.0 * t);
+
+			data[i] = (SampleType)x;
+		}
+	}
+}
+
+static void setParameter(J13AudioProcessor& processor, const juce::String& id, float value)
+{
+	auto* parameter = processor.apvts.getParameter(id);
+	parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+//==============================================================================
+// Control rate: the same automation rendered at 32 and 2048 sample host
+// buffers, with the settings advanced per control tick (16 and 32 samples)
+// or once per host block. Automation only moves on multiples of 2048
+// frames, so both buffer sizes see the same parameter values; with ticks
+// the two renders should match sample for sample, per block they should not.
+static std::vector<float> renderAutomation(int controlInterval, int blockSize, double& nanosecondsPerFrame)
+{
+	constexpr int automationStep = 2048;
+	constexpr int numFrames = automationStep * 200;
+	constexpr int numRuns = 5;
+
+	juce::AudioBuffer<float> buffer(2, blockSize);
+	juce::MidiBuffer midi;
+	std::vector<float> output((size_t)numFrames * 2);
+
+	// The fastest of a few runs, as the others mostly measure the machine
+	nanosecondsPerFrame = std::numeric_limits<double>::max();
+
+	for (int run = 0; run < numRuns; ++run) {
+		J13AudioProcessor processor;
+		processor.setControlInterval(controlInterval);
+		processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+		processor.prepareToPlay(sampleRate, blockSize);
+
+		double elapsed = 0.0;
+
+		for (int frame = 0; frame < numFrames; frame += blockSize) {
+			// Sweeps every band and the drive, a step every automationStep frames
+			if (frame % automationStep == 0) {
+				auto phase = (float)(frame / automationStep) * 0.37f;
+				auto sweep = 0.5f + 0.5f * std::sin(phase);
+
+				setParameter(processor, "LOWFREQ", 20.0f + 200.0f * sweep);
+				setParameter(processor, "LOWGAIN", -12.0f + 24.0f * sweep);
+				setParameter(processor, "LOWMIDFREQ", 220.0f + 3000.0f * sweep);
+				setParameter(processor, "LOWMIDGAIN", 12.0f - 24.0f * sweep);
+				setParameter(processor, "HIGHMIDFREQ", 1000.0f + 5000.0f * (1.0f - sweep));
+				setParameter(processor, "HIGHMIDGAIN", -9.0f + 18.0f * sweep);
+				setParameter(processor, "HIGHFREQ", 4000.0f + 16000.0f * sweep);
+				setParameter(processor, "HIGHGAIN", 6.0f * sweep);
+				setParameter(processor, "HIGHPASS", 20.0f + 200.0f * sweep);
+				setParameter(processor, "DRIVE", -6.0f + 12.0f * sweep);
+			}
+
+			fillTestSignal(buffer, frame);
+
+			auto start = juce::Time::getHighResolutionTicks();
+			processor.processBlock(buffer, midi);
+			elapsed += nanosecondsSince(start);
+
+			for (int i = 0; i < blockSize; ++i) {
+				output[(size_t)(frame + i) * 2] = buffer.getSample(0, i);
+				output[(size_t)(frame + i) * 2 + 1] = buffer.getSample(1, i);
+			}
+		}
+
+		nanosecondsPerFrame = juce::jmin(nanosecondsPerFrame, elapsed / numFrames);
+	}
+
+	return output;
+}
+
+static void benchmarkControlRate()
+{
+	std::printf("control rate: automation at 32 and 2048 sample buffers\n");
+	std::printf("  %-10s %14s %14s %16s\n", "interval", "ns/frame 32", "ns/frame 2048", "max difference");
+
+	for (auto interval : { 0, 16, 32 }) {
+		double smallCost = 0.0, largeCost = 0.0;
+		auto small = renderAutomation(interval, 32, smallCost);
+		auto large = renderAutomation(interval, 2048, largeCost);
+
+		auto difference = 0.0f;
+
+		for (size_t i = 0; i < small.size(); ++i)
+			difference = juce::jmax(difference, std::abs(small[i] - large[i]));
+
+		auto name = interval == 0 ? juce::String("per block") : juce::String(interval);
+		std::printf("  %-10s %14.1f %14.1f %16g\n", name.toRawUTF8(), smallCost, largeCost, (double)difference);
+	}
+}
+
+//==============================================================================
+// A stereo strip with every band doing something and the drive up, like a
+// typical bus setting, with the given curves
+static void prepareStrip(ChannelStrip& strip, int blockSize, SaturationProcessor::SaturationType inType,
+	SaturationProcessor::SaturationType outType)
+{
+	strip.prepare(sampleRate, blockSize, 2);
+	strip.primary.inSaturation.setSaturationType(inType);
+	strip.primary.outSaturation.setSaturationType(outType);
+	strip.primary.lowShelf.updateSettings(sampleRate, 120.0f, 0.7f, 1.5f);
+	strip.primary.lowMidPeak.updateSettings(sampleRate, 400.0f, 1.0f, 0.7f);
+	strip.primary.highMidPeak.updateSettings(sampleRate, 3000.0f, 1.0f, 1.4f);
+	strip.primary.highShelf.updateSettings(sampleRate, 8000.0f, 0.7f, 1.3f);
+	strip.primary.highPass.updateSettings(sampleRate, 40.0f);
+	strip.setGains(0.0f, 6.0f, 0.0f);
+}
+
+// The fastest of a few runs of the strip over the test signal, with a
+// control tick per host block
+static double timeStrip(ChannelStrip& strip, int blockSize)
+{
+	constexpr int numFrames = 1 << 18;
+	constexpr int numRuns = 5;
+
+	juce::AudioBuffer<float> buffer(2, blockSize);
+	auto nanosecondsPerFrame = std::numeric_limits<double>::max();
+
+	for (int run = 0; run < numRuns; ++run) {
+		double elapsed = 0.0;
+
+		for (int frame = 0; frame < numFrames; frame += blockSize) {
+			fillTestSignal(buffer, frame);
+
+			auto start = juce::Time::getHighResolutionTicks();
+			strip.beginControlInterval(blockSize);
+			strip.process(buffer, 0, blockSize);
+			elapsed += nanosecondsSince(start);
+		}
+
+		nanosecondsPerFrame = juce::jmin(nanosecondsPerFrame, elapsed / numFrames);
+	}
+
+	return nanosecondsPerFrame;
+}
+
+//==============================================================================
+// The chain as it was when oversampling came in, as the reference for its
+// budget: every stage one pass over the block per channel, the bands as
+// juce::dsp::IIR filters and the curves through a function pointer, the
+// way the old processor graph ran them. No graph overhead, so if anything
+// it is cheaper than the original.
+class ReferenceChain {
+public:
+	explicit ReferenceChain(ChannelStrip& strip)
+	{
+		for (auto& channel : filters)
+			for (int band = 0; band < ChannelStrip::numBands; ++band)
+				channel[(size_t)band] = juce::dsp::IIR::Filter<float>(strip.getCoeffs(band));
+	}
+
+	void process(juce::AudioBuffer<float>& buffer)
+	{
+		constexpr float driveGain = 1.9952623f, outputGain = 0.5011872f, driveOffset = 1.2589254f;
+
+		for (int channel = 0; channel < 2; ++channel) {
+			auto* data = buffer.getWritePointer(channel);
+			auto numSamples = buffer.getNumSamples();
+			auto& bands = filters[(size_t)channel];
+
+			auto applyGain = [data, numSamples](float gain) {
+				for (int i = 0; i < numSamples; ++i)
+					data[i] *= gain;
+			};
+
+			auto applyCurve = [data, numSamples](float (*curve)(float)) {
+				for (int i = 0; i < numSamples; ++i)
+					data[i] = curve(data[i]);
+			};
+
+			auto applyBand = [data, numSamples, &bands](int band) {
+				for (int i = 0; i < numSamples; ++i)
+					data[i] = bands[(size_t)band].processSample(data[i]);
+			};
+
+			applyGain(1.0f);
+			applyCurve(warm);
+			applyBand(ChannelStrip::lowShelfBand);
+			applyBand(ChannelStrip::lowMidBand);
+			applyGain(driveGain);
+			applyBand(ChannelStrip::highMidBand);
+			applyBand(ChannelStrip::highShelfBand);
+			applyCurve(thick);
+			applyGain(outputGain);
+			applyGain(driveOffset);
+			applyBand(ChannelStrip::highPassBand);
+		}
+	}
+
+private:
+	std::array<std::array<juce::dsp::IIR::Filter<float>, ChannelStrip::numBands>, 2> filters;
+
+	static float warm(float x)
+	{
+		auto a = 0.2f * tanhf(x);
+		auto b = 0.3f * sinf(x);
+		auto M = 2;
+
+		return 0.5f * tanhf(2 * (a + b) / M) + (a + b + x) / M;
+	}
+
+	static float thick(float x) { return tanhf(x); }
+};
+
+//==============================================================================
+// Oversampling: the whole chain with both saturation stages at each factor,
+// against the same chain at the host rate and against the reference chain.
+// The budget for 4x was twice the reference.
+static void benchmarkOversampling()
+{
+	constexpr int blockSize = 512;
+	constexpr int numFrames = 1 << 18;
+	constexpr int numRuns = 5;
+
+	ChannelStrip settings;
+	prepareStrip(settings, blockSize, SaturationProcessor::warm, SaturationProcessor::thick);
+	settings.beginControlInterval(blockSize);
+
+	ReferenceChain reference(settings);
+	juce::AudioBuffer<float> buffer(2, blockSize);
+	auto referenceCost = std::numeric_limits<double>::max();
+
+	for (int run = 0; run < numRuns; ++run) {
+		double elapsed = 0.0;
+
+		for (int frame = 0; frame < numFrames; frame += blockSize) {
+			fillTestSignal(buffer, frame);
+
+			auto start = juce::Time::getHighResolutionTicks();
+			reference.process(buffer);
+			elapsed += nanosecondsSince(start);
+		}
+
+		referenceCost = juce::jmin(referenceCost, elapsed / numFrames);
+	}
+
+	std::printf("oversampling: stereo strip, warm in, thick out, %d sample blocks\n", blockSize);
+	std::printf("  %-10s %10s %10s %14s\n", "factor", "ns/frame", "vs 1x", "vs reference");
+	std::printf("  %-10s %10.1f\n", "reference", referenceCost);
+
+	auto hostRateCost = 0.0;
+
+	for (int numStages = 0; numStages <= Oversampler<float>::maxStages; ++numStages) {
+		ChannelStrip strip;
+		prepareStrip(strip, blockSize, SaturationProcessor::warm, SaturationProcessor::thick);
+		strip.setOversampling(numStages);
+
+		auto cost = timeStrip(strip, blockSize);
+
+		if (numStages == 0)
+			hostRateCost = cost;
+
+		auto name = juce::String(1 << numStages) + "x";
+		std::printf("  %-10s %10.1f %10.2f %14.2f\n", name.toRawUTF8(), cost, cost / hostRateCost, cost / referenceCost);
+	}
+}
+
+//==============================================================================
+// Aliasing: a 7.9 kHz tone driven to 3.0 (+9.5 dB) through the input
+// saturation, every band flat and the output clean. From the 4th harmonic up
+// the curve's harmonics fold back below Nyquist, in between the three that
+// fit. Over one second every component lands on a whole Hz, so the DFT at
+// the harmonics is exact and whatever power is left over is aliasing. It is
+// reported against the fundamental, next to the cost of the strip.
+static double measureAliasing(ChannelStrip& strip)
+{
+	constexpr double frequency = 7900.0, amplitude = 3.0;
+	constexpr int blockSize = 480;
+	constexpr int settleFrames = 12000, numFrames = 48000;
+
+	juce::AudioBuffer<float> buffer(2, blockSize);
+	std::vector<double> output;
+	output.reserve(numFrames);
+
+	for (int frame = 0; frame < settleFrames + numFrames; frame += blockSize) {
+		for (int channel = 0; channel < 2; ++channel) {
+			auto* data = buffer.getWritePointer(channel);
+
+			for (int i = 0; i < blockSize; ++i)
+				data[i] = (float)(amplitude
+					* std::sin(juce::MathConstants<double>::twoPi * frequency * (double)(frame + i) / sampleRate));
+		}
+
+		strip.beginControlInterval(blockSize);
+		strip.process(buffer, 0, blockSize);
+
+		if (frame >= settleFrames)
+			for (int i = 0; i < blockSize; ++i)
+				output.push_back(buffer.getSample(0, i));
+	}
+
+	// Power of the component at f, from one bin of the DFT
+	auto powerAt = [&output](double f) {
+		double re = 0.0, im = 0.0;
+
+		for (size_t n = 0; n < output.size(); ++n) {
+			auto phase = juce::MathConstants<double>::twoPi * f * (double)n / sampleRate;
+			re += output[n] * std::cos(phase);
+			im -= output[n] * std::sin(phase);
+		}
+
+		auto power = (re * re + im * im) / ((double)numFrames * numFrames);
+		return f == 0.0 ? power : 2.0 * power;
+	};
+
+	auto total = 0.0;
+
+	for (auto x : output)
+		total += x * x;
+
+	total /= numFrames;
+
+	auto harmonics = 0.0;
+
+	for (int k = 0; k * frequency < sampleRate / 2.0; ++k)
+		harmonics += powerAt(k * frequency);
+
+	auto aliased = juce::jmax(total - harmonics, 1.0e-20);
+	return 10.0 * std::log10(aliased / powerAt(frequency));
+}
+
+static void benchmarkAliasing()
+{
+	struct Mode {
+		const char* name;
+		int oversampling;
+		SaturationProcessor::Antialiasing antialiasing;
+	};
+
+	const Mode modes[] = {
+		{ "plain", 0, SaturationProcessor::noAntialiasing },
+		{ "adaa 1", 0, SaturationProcessor::firstOrderAdaa },
+		{ "adaa 2", 0, SaturationProcessor::secondOrderAdaa },
+		{ "2x", 1, SaturationProcessor::noAntialiasing },
+		{ "4x", 2, SaturationProcessor::noAntialiasing },
+		{ "8x", 3, SaturationProcessor::noAntialiasing },
+		{ "2x adaa 1", 1, SaturationProcessor::firstOrderAdaa },
+	};
+
+	const SaturationProcessor::SaturationType curves[] = { SaturationProcessor::warm, SaturationProcessor::bright,
+		SaturationProcessor::thick };
+
+	std::printf("aliasing: 7.9 kHz at +9.5 dB into the input saturation, alias power against the fundamental\n");
+	std::printf("  %-10s %10s %9s %10s %9s %10s %9s\n", "mode", "warm dB", "ns/frame", "bright dB", "ns/frame", "thick dB",
+		"ns/frame");
+
+	for (auto& mode : modes) {
+		std::printf("  %-10s", mode.name);
+
+		for (auto curve : curves) {
+			ChannelStrip strip;
+			strip.prepare(sampleRate, 512, 2);
+			strip.primary.inSaturation.setSaturationType(curve);
+			strip.primary.lowShelf.updateSettings(sampleRate, 200.0f, 0.7f, 1.0f);
+			strip.primary.highPass.updateSettings(sampleRate, HighPassProcessor::minFrequency);
+			strip.setGains(0.0f, 0.0f, 0.0f);
+			strip.setOversampling(mode.oversampling);
+			strip.setAntialiasing(mode.antialiasing);
+
+			auto aliasing = measureAliasing(strip);
+			auto cost = timeStrip(strip, 512);
+
+			std::printf(" %10.1f %9.1f", aliasing, cost);
+		}
+
+		std::printf("\n");
+	}
+}
+
+//==============================================================================
+// Tiles: the strip across host block sizes for a few tile sizes, with clean
+// curves and with warm and thick. Throughput should not depend on the block.
+static void benchmarkTiles()
+{
+	const int blockSizes[] = { 64, 256, 1024, 2048, 4096, 8192 };
+	const int tileSizes[] = { 16, 128, 512 };
+
+	std::printf("tiles: stereo strip, ns/frame across host block sizes\n");
+	std::printf("  %-20s", "block");
+
+	for (auto blockSize : blockSizes)
+		std::printf(" %7d", blockSize);
+
+	std::printf("\n");
+
+	for (auto saturated : { false, true }) {
+		for (auto tileSize : tileSizes) {
+			auto name = juce::String(saturated ? "warm+thick" : "clean") + ", tile " + juce::String(tileSize);
+			std::printf("  %-20s", name.toRawUTF8());
+
+			for (auto blockSize : blockSizes) {
+				ChannelStrip strip;
+				prepareStrip(strip, blockSize, saturated ? SaturationProcessor::warm : SaturationProcessor::clean,
+					saturated ? SaturationProcessor::thick : SaturationProcessor::clean);
+				strip.setTileSize(tileSize);
+
+				std::printf(" %7.1f", timeStrip(strip, blockSize));
+			}
+
+			std::printf("\n");
+		}
+	}
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+	// The processor's parameters and async updates expect a message manager
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	struct Benchmark {
+		const char* name;
+		void (*run)();
+	};
+
+	const Benchmark benchmarks[] = {
+		{ "control", benchmarkControlRate },
+		{ "oversampling", benchmarkOversampling },
+		{ "aliasing", benchmarkAliasing },
+		{ "tiles", benchmarkTiles },
+	};
+
+	auto selected = argc > 1 ? juce::String(argv[1]) : juce::String();
+	auto found = false;
+
+	for (auto& benchmark : benchmarks) {
+		if (selected.isNotEmpty() && selected != benchmark.name)
+			continue;
+
+		benchmark.run();
+		found = true;
+	}
+
+	if (!found) {
+		std::printf("usage: j13bench [");
+
+		for (auto& benchmark : benchmarks)
+			std::printf(" %s", benchmark.name);
+
+		std::printf(" ]\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    Antiderivatives.h
+    Created: 17 Oct 2026 4:05:31pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// First and second antiderivatives of a saturation curve, for antiderivative
+// anti-aliasing (ADAA). The curves have no convenient closed forms (warm has
+// none at all), so F1 and F2 are integrated once in double on a fine grid and
+// read back with Hermite interpolation:
+//
+//   F1 is cubic from F1 and f at the knots, F2 is quintic from F2, F1 and f.
+//
+// That keeps the interpolants' derivatives close to f, which is what the
+// ADAA difference quotients see. Past +-range the curve is continued as a
+// straight line with its asymptotic slope.
+class AntiderivativeTable {
+public:
+	static constexpr double range = 64.0;
+	static constexpr double step = 1.0 / 32.0;
+	static constexpr int numPoints = (int)(2.0 * range / step) + 1;
+
+	template <typename Curve>
+	AntiderivativeTable(Curve curve, double asymptoticSlope)
+		: slope(asymptoticSlope)
+	{
+		f0.resize(numPoints);
+		f1.resize(numPoints);
+		f2.resize(numPoints);
+
+		auto centre = numPoints / 2;
+		f1[(size_t)centre] = 0.0;
+		f2[(size_t)centre] = 0.0;
+
+		for (int i = 0; i < numPoints; ++i)
+			f0[(size_t)i] = curve(knot(i));
+
+		// integrate outwards from 0, with 5 point Gauss-Legendre on each cell
+		for (int i = centre + 1; i < numPoints; ++i) {
+			auto a = knot(i - 1);
+			auto integral = integrate(curve, a, [](double) { return 1.0; });
+			auto moment = integrate(curve, a, [a](double t) { return a + step - t; });
+
+			f1[(size_t)i] = f1[(size_t)i - 1] + integral;
+			f2[(size_t)i] = f2[(size_t)i - 1] + step * f1[(size_t)i - 1] + moment;
+		}
+
+		for (int i = centre - 1; i >= 0; --i) {
+			auto a = knot(i);
+			auto integral = integrate(curve, a, [](double) { return 1.0; });
+			auto moment = integrate(curve, a, [a](double t) { return t - a; });
+
+			f1[(size_t)i] = f1[(size_t)i + 1] - integral;
+			f2[(size_t)i] = f2[(size_t)i + 1] - (step * f1[(size_t)i + 1] - moment);
+		}
+	}
+
+	// The curve, as the derivative of the F1 interpolant
+	double f(double x) const noexcept
+	{
+		if (std::abs(x) >= range) {
+			auto edge = x > 0.0 ? numPoints - 1 : 0;
+			return f0[(size_t)edge] + slope * (x - knot(edge));
+		}
+
+		auto [i, t] = locate(x);
+		auto p0 = f1[i], p1 = f1[i + 1], m0 = step * f0[i], m1 = step * f0[i + 1];
+
+		return ((6.0 * t * t - 6.0 * t) * (p0 - p1) + (3.0 * t * t - 4.0 * t + 1.0) * m0 + (3.0 * t * t - 2.0 * t) * m1) / step;
+	}
+
+	double antiderivative1(double x) const noexcept
+	{
+		if (std::abs(x) >= range) {
+			auto edge = x > 0.0 ? numPoints - 1 : 0;
+			auto d = x - knot(edge);
+			return f1[(size_t)edge] + d * (f0[(size_t)edge] + d * slope / 2.0);
+		}
+
+		auto [i, t] = locate(x);
+		auto t2 = t * t, t3 = t2 * t;
+
+		return (2.0 * t3 - 3.0 * t2 + 1.0) * f1[i] + (t3 - 2.0 * t2 + t) * step * f0[i] + (-2.0 * t3 + 3.0 * t2) * f1[i + 1]
+			+ (t3 - t2) * step * f0[i + 1];
+	}
+
+	double antiderivative2(double x) const noexcept
+	{
+		if (std::abs(x) >= range) {
+			auto edge = x > 0.0 ? numPoints - 1 : 0;
+			auto d = x - knot(edge);
+			return f2[(size_t)edge] + d * (f1[(size_t)edge] + d * (f0[(size_t)edge] / 2.0 + d * slope / 6.0));
+		}
+
+		auto [i, t] = locate(x);
+		auto t2 = t * t, t3 = t2 * t, t4 = t3 * t, t5 = t4 * t;
+		auto h2 = step * step;
+
+		return (1.0 - 10.0 * t3 + 15.0 * t4 - 6.0 * t5) * f2[i] + (t - 6.0 * t3 + 8.0 * t4 - 3.0 * t5) * step * f1[i]
+			+ 0.5 * (t2 - 3.0 * t3 + 3.0 * t4 - t5) * h2 * f0[i] + 0.5 * (t3 - 2.0 * t4 + t5) * h2 * f0[i + 1]
+			+ (-4.0 * t3 + 7.0 * t4 - 3.0 * t5) * step * f1[i + 1] + (10.0 * t3 - 15.0 * t4 + 6.0 * t5) * f2[i + 1];
+	}
+
+private:
+	double slope;
+	std::vector<double> f0, f1, f2;
+
+	static double knot(int i) noexcept { return -range + i * step; }
+
+	// cell index and position 0..1 inside it, for |x| < range
+	static std::pair<size_t, double> locate(double x) noexcept
+	{
+		auto position = (x + range) / step;
+		auto i = juce::jlimit(0, numPoints - 2, (int)position);
+		return { (size_t)i, position - i };
+	}
+
+	template <typename Curve, typename Weight>
+	static double integrate(Curve& curve, double a, Weight weight)
+	{
+		static constexpr double nodes[] = { 0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640,
+			0.9061798459386640 };
+		static constexpr double weights[] = { 0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891,
+			0.2369268850561891 };
+
+		double sum = 0.0;
+
+		for (int k = 0; k < 5; ++k) {
+			auto t = a + 0.5 * step * (1.0 + nodes[k]);
+			sum += weights[k] * curve(t) * weight(t);
+		}
+
+		return 0.5 * step * sum;
+	}
+};
@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+    Created: 17 Oct 2026 10:02:51am
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Plain C++ stand-in for juce::dsp::SIMDRegister with the same number of
+// lanes, used when the CPU has no usable vector unit.
+template <typename Type, size_t numLanes>
+struct ScalarLanes {
+	using ElementType = Type;
+	static constexpr size_t SIMDNumElements = numLanes;
+
+	Type value[numLanes];
+
+	static ScalarLanes expand(Type s) noexcept
+	{
+		ScalarLanes r;
+		std::fill(r.value, r.value + numLanes, s);
+		return r;
+	}
+
+	static ScalarLanes fromRawArray(const Type* a) noexcept
+	{
+		ScalarLanes r {};
+		std::copy(a, a + numLanes, r.value);
+		return r;
+	}
+
+	void copyToRawArray(Type* a) const noexcept { std::copy(value, value + numLanes, a); }
+
+	Type get(size_t lane) const noexcept { return value[lane]; }
+	void set(size_t lane, Type v) noexcept { value[lane] = v; }
+
+	ScalarLanes& operator+=(const ScalarLanes& o) noexcept
+	{
+		for (size_t i = 0; i < numLanes; ++i)
+			value[i] += o.value[i];
+		return *this;
+	}
+
+	ScalarLanes& operator-=(const ScalarLanes& o) noexcept
+	{
+		for (size_t i = 0; i < numLanes; ++i)
+			value[i] -= o.value[i];
+		return *this;
+	}
+
+	ScalarLanes& operator*=(const ScalarLanes& o) noexcept
+	{
+		for (size_t i = 0; i < numLanes; ++i)
+			value[i] *= o.value[i];
+		return *this;
+	}
+
+	ScalarLanes operator+(const ScalarLanes& o) const noexcept { return ScalarLanes(*this) += o; }
+	ScalarLanes operator-(const ScalarLanes& o) const noexcept { return ScalarLanes(*this) -= o; }
+	ScalarLanes operator*(const ScalarLanes& o) const noexcept { return ScalarLanes(*this) *= o; }
+
+	static ScalarLanes min(ScalarLanes a, const ScalarLanes& b) noexcept
+	{
+		for (size_t i = 0; i < numLanes; ++i)
+			a.value[i] = juce::jmin(a.value[i], b.value[i]);
+		return a;
+	}
+
+	static ScalarLanes max(ScalarLanes a, const ScalarLanes& b) noexcept
+	{
+		for (size_t i = 0; i < numLanes; ++i)
+			a.value[i] = juce::jmax(a.value[i], b.value[i]);
+		return a;
+	}
+
+	static ScalarLanes truncate(ScalarLanes a) noexcept
+	{
+		for (size_t i = 0; i < numLanes; ++i)
+			a.value[i] = std::trunc(a.value[i]);
+		return a;
+	}
+};
+
+//==============================================================================
+// The five EQ biquads run back to back, with every channel of a sample frame
+// held in its own lane of one vector register. Coefficients and state are kept
+// lane-interleaved so a band costs the same for one channel as for four.
+//
+// Coefficients are stored per lane; normally every lane gets the same set.
+// SampleType is float or double, for the host's processing precision.
+template <typename SampleType>
+class BiquadCascade {
+public:
+	// One register of the width JUCE's SIMDRegister is built with: 128 bits
+	// for SSE or NEON, four float or two double lanes, and 256 bits when JUCE
+	// is built for AVX2. The width is fixed at compile time; there is no
+	// runtime switch between SSE and AVX. Without JUCE_USE_SIMD the fallback
+	// keeps the 128-bit layout.
+#if JUCE_USE_SIMD
+	static constexpr size_t registerSize = juce::dsp::SIMDRegister<float>::SIMDRegisterSize;
+#else
+	static constexpr size_t registerSize = 16;
+#endif
+
+	static constexpr size_t numLanes = registerSize / sizeof(SampleType);
+	using FallbackLanes = ScalarLanes<SampleType, numLanes>;
+
+#if JUCE_USE_SIMD
+	using SIMDLanes = juce::dsp::SIMDRegister<SampleType>;
+	static_assert(SIMDLanes::SIMDNumElements == numLanes, "lane layout differs from SIMDRegister");
+#else
+	using SIMDLanes = FallbackLanes;
+#endif
+
+	static constexpr int numStages = 5;
+
+	BiquadCascade()
+	{
+		for (int stage = 0; stage < numStages; ++stage) {
+			const double passThrough[] = { 1.0, 0.0, 0.0, 0.0, 0.0 };
+			setCoefficients(stage, passThrough);
+		}
+
+		reset();
+	}
+
+	// True when the CPU has the instructions the build's registers need,
+	// checked once in prepare(). If not, the scalar fallback runs instead.
+	static bool hasSIMD()
+	{
+#if JUCE_USE_SIMD && JUCE_USE_SSE_INTRINSICS && defined(__AVX2__)
+		return juce::SystemStats::hasAVX2();
+#elif JUCE_USE_SIMD && JUCE_USE_SSE_INTRINSICS
+		return juce::SystemStats::hasSSE2();
+#elif JUCE_USE_SIMD && JUCE_USE_ARM_NEON
+		return juce::SystemStats::hasNeon();
+#else
+		return false;
+#endif
+	}
+
+	// raw is b0, b1, b2, a1, a2 normalised by a0, the layout of IIR::Coefficients
+	void setCoefficients(int stage, const double* raw)
+	{
+		for (int k = 0; k < numCoeffs; ++k)
+			std::fill(coeffs[stage][k], coeffs[stage][k] + numLanes, (SampleType)raw[k]);
+	}
+
+	// The same for a single lane, e.g. the side channel in mid/side mode
+	void setCoefficients(int stage, const double* raw, size_t lane)
+	{
+		for (int k = 0; k < numCoeffs; ++k)
+			coeffs[stage][k][lane] = (SampleType)raw[k];
+	}
+
+	void reset()
+	{
+		for (auto& stage : state)
+			for (auto& lanes : stage)
+				std::fill(lanes, lanes + numLanes, SampleType());
+	}
+
+	// Clears one stage, e.g. before it is brought back in after a bypass
+	void resetStage(int stage)
+	{
+		for (auto& lanes : state[stage])
+			std::fill(lanes, lanes + numLanes, SampleType());
+	}
+
+	void snapToZero() noexcept
+	{
+		for (auto& stage : state)
+			for (auto& lanes : stage)
+				for (auto& s : lanes)
+					JUCE_SNAP_TO_ZERO(s);
+	}
+
+	//==========================================================================
+	// Register copy of the cascade for the length of one block. Build it before
+	// the sample loop and call store() after it.
+	template <typename Lanes>
+	class Registers {
+	public:
+		explicit Registers(const BiquadCascade& cascade)
+		{
+			for (int i = 0; i < numStages; ++i) {
+				auto& stage = stages[i];
+				stage.b0 = Lanes::fromRawArray(cascade.coeffs[i][0]);
+				stage.b1 = Lanes::fromRawArray(cascade.coeffs[i][1]);
+				stage.b2 = Lanes::fromRawArray(cascade.coeffs[i][2]);
+				stage.a1 = Lanes::fromRawArray(cascade.coeffs[i][3]);
+				stage.a2 = Lanes::fromRawArray(cascade.coeffs[i][4]);
+				stage.s1 = Lanes::fromRawArray(cascade.state[i][0]);
+				stage.s2 = Lanes::fromRawArray(cascade.state[i][1]);
+			}
+		}
+
+		void store(BiquadCascade& cascade) const
+		{
+			for (int i = 0; i < numStages; ++i) {
+				stages[i].s1.copyToRawArray(cascade.state[i][0]);
+				stages[i].s2.copyToRawArray(cascade.state[i][1]);
+			}
+		}
+
+		// Transposed direct form II
+		Lanes processStage(int stageNum, Lanes x) noexcept
+		{
+			auto& stage = stages[stageNum];
+
+			auto y = stage.b0 * x + stage.s1;
+			stage.s1 = stage.b1 * x - stage.a1 * y + stage.s2;
+			stage.s2 = stage.b2 * x - stage.a2 * y;
+
+			return y;
+		}
+
+	private:
+		struct Stage {
+			Lanes b0, b1, b2, a1, a2;
+			Lanes s1, s2;
+		};
+
+		Stage stages[numStages];
+	};
+
+private:
+	static constexpr int numCoeffs = 5;
+
+	alignas(32) SampleType coeffs[numStages][numCoeffs][numLanes];
+	alignas(32) SampleType state[numStages][2][numLanes];
+};
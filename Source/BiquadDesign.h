@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    BiquadDesign.h
+    Created: 17 Oct 2026 11:20:37am
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Real-time safe versions of the IIR::Coefficients<float>::make* functions
+// used by the EQ bands. They give the same filters but write the five
+// normalised values (b0, b1, b2, a1, a2) into storage owned by the caller,
+// so nothing is allocated and no reference count is touched. The values stay
+// in double, so the double precision engine gets the full design.
+struct BiquadDesign {
+	static constexpr int numCoeffs = 5;
+
+	static void makeHighPass(
+		double* raw, double sampleRate, double frequency, double Q = 1.0 / juce::MathConstants<double>::sqrt2)
+	{
+		auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+		auto nSquared = n * n;
+		auto invQ = 1.0 / Q;
+		auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+		store(raw, c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+	}
+
+	static void makeLowShelf(double* raw, double sampleRate, double cutOffFrequency, double Q, double gainFactor)
+	{
+		auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+		auto aminus1 = A - 1.0;
+		auto aplus1 = A + 1.0;
+		auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(cutOffFrequency, 2.0)) / sampleRate;
+		auto coso = std::cos(omega);
+		auto beta = std::sin(omega) * std::sqrt(A) / Q;
+		auto aminus1TimesCoso = aminus1 * coso;
+
+		store(raw,
+			A * (aplus1 - aminus1TimesCoso + beta),
+			A * 2.0 * (aminus1 - aplus1 * coso),
+			A * (aplus1 - aminus1TimesCoso - beta),
+			aplus1 + aminus1TimesCoso + beta,
+			-2.0 * (aminus1 + aplus1 * coso),
+			aplus1 + aminus1TimesCoso - beta);
+	}
+
+	static void makeHighShelf(double* raw, double sampleRate, double cutOffFrequency, double Q, double gainFactor)
+	{
+		auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+		auto aminus1 = A - 1.0;
+		auto aplus1 = A + 1.0;
+		auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(cutOffFrequency, 2.0)) / sampleRate;
+		auto coso = std::cos(omega);
+		auto beta = std::sin(omega) * std::sqrt(A) / Q;
+		auto aminus1TimesCoso = aminus1 * coso;
+
+		store(raw,
+			A * (aplus1 + aminus1TimesCoso + beta),
+			A * -2.0 * (aminus1 + aplus1 * coso),
+			A * (aplus1 + aminus1TimesCoso - beta),
+			aplus1 - aminus1TimesCoso + beta,
+			2.0 * (aminus1 - aplus1 * coso),
+			aplus1 - aminus1TimesCoso - beta);
+	}
+
+	static void makePeakFilter(double* raw, double sampleRate, double frequency, double Q, double gainFactor)
+	{
+		auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+		auto omega = (juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0)) / sampleRate;
+		auto alpha = std::sin(omega) / (Q * 2.0);
+		auto c2 = -2.0 * std::cos(omega);
+		auto alphaTimesA = alpha * A;
+		auto alphaOverA = alpha / A;
+
+		store(raw, 1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+	}
+
+	// True when raw passes the signal unchanged, e.g. a shelf or peak at 0 dB
+	static bool isIdentity(const double* raw) noexcept
+	{
+		constexpr double tolerance = 1.0e-9;
+
+		return std::abs(raw[0] - 1.0) < tolerance && std::abs(raw[1] - raw[3]) < tolerance
+			&& std::abs(raw[2] - raw[4]) < tolerance;
+	}
+
+	// Samples for the impulse response of raw to fall by decayFactor, from the
+	// radius of its slowest pole. A pole on or outside the unit circle gives
+	// maxSamples.
+	static double getDecaySamples(const double* raw, double decayFactor, double maxSamples) noexcept
+	{
+		auto a1 = raw[3], a2 = raw[4];
+		auto discriminant = a1 * a1 - 4.0 * a2;
+
+		auto radius = discriminant < 0.0 ? std::sqrt(a2) : 0.5 * (std::abs(a1) + std::sqrt(discriminant));
+
+		if (radius >= 1.0)
+			return maxSamples;
+
+		if (radius <= 0.0)
+			return 2.0;
+
+		return juce::jmin(maxSamples, std::log(decayFactor) / std::log(radius) + 2.0);
+	}
+
+private:
+	static void store(double* raw, double b0, double b1, double b2, double a0, double a1, double a2) noexcept
+	{
+		auto a0inv = 1.0 / a0;
+
+		raw[0] = b0 * a0inv;
+		raw[1] = b1 * a0inv;
+		raw[2] = b2 * a0inv;
+		raw[3] = a1 * a0inv;
+		raw[4] = a2 * a0inv;
+	}
+};
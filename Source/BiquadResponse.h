@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    BiquadResponse.h
+    Created: 17 Oct 2026 9:12:47pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+#include "FastMath.h"
+
+//==============================================================================
+// Magnitude, and optionally phase, of raw biquads at a fixed set of
+// frequencies, for the plot and anything else that needs whole responses.
+// Coefficients are { b0, b1, b2, a1, a2 }, the layout of IIR::Coefficients
+// and BiquadDesign.
+//
+// The trig is tabulated once per set of frequencies and the points run
+// through SIMD registers, so a response costs a handful of multiplies per
+// point. Everything is written in phi = sin^2(w / 2) and sin w:
+//
+//   |B|^2  = (b0 + b1 + b2)^2 - 4 (b0 b1 + b1 b2 + 4 b0 b2) phi + 16 b0 b2 phi^2
+//   Re B   = (b0 + b1 + b2) - 2 (b1 + 4 b2) phi + 8 b2 phi^2
+//   Im B   = -sin w ((b1 + 2 b2) - 4 b2 phi)
+//
+// and the same for A with a0 = 1. That keeps its accuracy near DC, where
+// the plain cos w form cancels down to nothing in float.
+class BiquadResponse {
+public:
+	static constexpr int numCoeffs = 5;
+
+	using SIMDLanes = BiquadCascade<float>::SIMDLanes;
+	using FallbackLanes = BiquadCascade<float>::FallbackLanes;
+	static constexpr size_t numLanes = BiquadCascade<float>::numLanes;
+
+	BiquadResponse()
+		: useSIMD(BiquadCascade<float>::hasSIMD())
+	{
+	}
+
+	// The points to evaluate at, in Hz
+	void setFrequencies(const float* frequencies, int numFrequencies, double sampleRate)
+	{
+		numPoints = juce::jmax(0, numFrequencies);
+
+		phi.resize((size_t)numPoints);
+		sinW.resize((size_t)numPoints);
+
+		for (int i = 0; i < numPoints; ++i) {
+			auto w = juce::MathConstants<double>::twoPi * (double)frequencies[i] / sampleRate;
+			auto s = std::sin(0.5 * w);
+
+			phi.data[i] = (float)(s * s);
+			sinW.data[i] = (float)std::sin(w);
+		}
+	}
+
+	int getNumFrequencies() const noexcept { return numPoints; }
+
+	// One biquad. magnitudes, and phases in radians if not nullptr, get
+	// getNumFrequencies() values.
+	void process(const float* coefficients, float* magnitudes, float* phases = nullptr) const
+	{
+		if (useSIMD) {
+			processSet<SIMDLanes>(coefficients, magnitudes, phases);
+		} else {
+			processSet<FallbackLanes>(coefficients, magnitudes, phases);
+		}
+	}
+
+	// Several biquads against the same frequencies
+	void process(const float* const* coefficientSets, int numSets, float* const* magnitudes,
+		float* const* phases = nullptr) const
+	{
+		for (int set = 0; set < numSets; ++set)
+			process(coefficientSets[set], magnitudes[set], phases != nullptr ? phases[set] : nullptr);
+	}
+
+private:
+	// A float array padded to whole registers and aligned for them
+	struct Table {
+		std::vector<float> storage;
+		float* data = nullptr;
+
+		void resize(size_t size)
+		{
+			auto padded = (size + numLanes - 1) / numLanes * numLanes;
+			storage.assign(padded + numLanes, 0.0f);
+			data = juce::snapPointerToAlignment(storage.data(), BiquadCascade<float>::registerSize);
+		}
+	};
+
+	bool useSIMD;
+	int numPoints = 0;
+	Table phi, sinW;
+
+	// The phi polynomials of |X|^2, Re X and Im X / -sin w, for X = x0 + x1 z^-1 + x2 z^-2
+	struct Polynomials {
+		float power[3], re[3], im[2];
+
+		Polynomials(double x0, double x1, double x2) noexcept
+		{
+			auto sum = x0 + x1 + x2;
+
+			power[0] = (float)(sum * sum);
+			power[1] = (float)(-4.0 * (x0 * x1 + x1 * x2 + 4.0 * x0 * x2));
+			power[2] = (float)(16.0 * x0 * x2);
+
+			re[0] = (float)sum;
+			re[1] = (float)(-2.0 * (x1 + 4.0 * x2));
+			re[2] = (float)(8.0 * x2);
+
+			im[0] = (float)(x1 + 2.0 * x2);
+			im[1] = (float)(-4.0 * x2);
+		}
+
+		template <typename Lanes>
+		static Lanes evaluate(const float* polynomial, int order, Lanes p) noexcept
+		{
+			auto y = Lanes::expand(polynomial[order]);
+
+			for (int i = order - 1; i >= 0; --i)
+				y = y * p + Lanes::expand(polynomial[i]);
+
+			return y;
+		}
+	};
+
+	template <typename Lanes>
+	void processSet(const float* c, float* magnitudes, float* phases) const
+	{
+		const Polynomials b(c[0], c[1], c[2]), a(1.0, c[3], c[4]);
+		const auto zero = Lanes::expand(0.0f);
+
+		alignas(32) float power[numLanes], re[numLanes], im[numLanes];
+
+		for (int start = 0; start < numPoints; start += (int)numLanes) {
+			auto count = juce::jmin((int)numLanes, numPoints - start);
+			auto p = Lanes::fromRawArray(phi.data + start);
+
+			auto top = Polynomials::evaluate(b.power, 2, p);
+			auto bottom = Polynomials::evaluate(a.power, 2, p);
+
+			// Rounding can take a response with a zero on the unit circle just below 0
+			FastMath::divide(Lanes::max(top, zero), bottom).copyToRawArray(power);
+
+			for (int i = 0; i < count; ++i)
+				magnitudes[start + i] = std::sqrt(power[i]);
+
+			if (phases == nullptr)
+				continue;
+
+			auto sw = Lanes::fromRawArray(sinW.data + start);
+
+			// B and A at e^jw, and arg(B / A) as arg(B conj(A))
+			auto bRe = Polynomials::evaluate(b.re, 2, p);
+			auto bIm = zero - sw * Polynomials::evaluate(b.im, 1, p);
+			auto aRe = Polynomials::evaluate(a.re, 2, p);
+			auto aIm = zero - sw * Polynomials::evaluate(a.im, 1, p);
+
+			(bRe * aRe + bIm * aIm).copyToRawArray(re);
+			(bIm * aRe - bRe * aIm).copyToRawArray(im);
+
+			for (int i = 0; i < count; ++i)
+				phases[start + i] = std::atan2(im[i], re[i]);
+		}
+	}
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadResponse)
+};
@@ -0,0 +1,1134 @@
+/*
+  ==============================================================================
+
+    ChannelStrip.h
+    Created: 17 Oct 2026 9:14:02am
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+#include "DynamicPeak.h"
+#include "Filters.h"
+#include "GainProcessor.h"
+#include "LinearPhaseEq.h"
+#include "Oversampler.h"
+#include "Saturation.h"
+#include "StageTimer.h"
+#include "SvfFilter.h"
+
+//==============================================================================
+// The complete J13 signal chain. Every stage is applied to a sample frame
+// before moving on to the next one, so each block is walked only once. The
+// channels of a frame travel together in the lanes of one vector register:
+//
+//   in gain -> in saturation -> low shelf -> low-mid peak -> drive ->
+//   high-mid peak -> high shelf -> out saturation -> out gain -> high pass
+//
+// The out gain also takes the drive back out, see setGains(). The two
+// saturation stages can run oversampled, see Oversampler.
+//
+// Up to maxChannels channels are packed into lane groups, as many as fit in
+// one register, each with its own filter, oversampler and ADAA state. The
+// register is as wide as the build targets, see BiquadCascade: in float, 4
+// groups of 4 on SSE or NEON and 2 groups of 8 on AVX2. A mono strip runs a
+// one lane scalar kernel instead of a mostly empty vector.
+//
+// The lane groups and the tile exist once per sample type, so the same code
+// runs in float or in double, whichever the host asks for. The linear phase
+// EQ is the exception: juce::dsp::FFT only works in float, so it convolves
+// in float either way.
+//
+// In linear phase mode the bands are instead linear phase FIRs, see
+// LinearPhaseEq, in their places in the chain: the low shelf and low-mid
+// peak as one FIR before the drive, the high-mid peak and high shelf as
+// another before the output saturation, and the high pass as a third after
+// the output gain. Each FIR adds its own latency.
+//
+// In mid/side mode a stereo strip is encoded to M and S as the tile is
+// filled and decoded as it is emptied. M runs on the primary stages and S,
+// in the second lane, on the side stages: the bands as per-lane
+// coefficients, the saturations as a one lane side shaper for S alone.
+//
+// The two mid peaks can be dynamic, see DynamicPeak, detecting on their own
+// band or on the same band of a key input. M and S share the dynamics
+// settings. In linear phase mode a dynamic peak is left out of its FIR and
+// runs in its place next to it, always on its own band: the key would be
+// out of step with the signal the FIR before it has delayed.
+//
+// A band that goes flat, see FilterBand::isFlat(), is faded out over
+// fadeSeconds and then skipped. When it moves again it is faded back in
+// from cleared state, which is where a flat biquad settles anyway.
+class ChannelStrip {
+public:
+	ChannelStrip() { }
+
+	enum Band { lowShelfBand = 0, lowMidBand = 1, highMidBand = 2, highShelfBand = 3, highPassBand = 4, numBands = 5 };
+
+	// Enough for a 7.1.4 bed, or 9.1.6 with room to spare
+	static constexpr int maxChannels = 16;
+
+	// The bands that can be dynamic
+	static constexpr int numDynamicBands = 2;
+	static constexpr Band dynamicBands[numDynamicBands] = { lowMidBand, highMidBand };
+
+	// The stages that mid and side can set apart, in processing order
+	struct StageSet {
+		SaturationProcessor inSaturation;
+		LowShelfProcessor lowShelf;
+		PeakProcessor lowMidPeak;
+		PeakProcessor highMidPeak;
+		HighShelfProcessor highShelf;
+		SaturationProcessor outSaturation;
+		HighPassProcessor highPass;
+
+		void prepare(double sampleRate)
+		{
+			lowShelf.prepare(sampleRate);
+			lowMidPeak.prepare(sampleRate);
+			highMidPeak.prepare(sampleRate);
+			highShelf.prepare(sampleRate);
+			highPass.prepare(sampleRate);
+		}
+
+		FilterBand& getBand(int filterNum)
+		{
+			switch (filterNum) {
+			case lowShelfBand:
+				return lowShelf;
+			case lowMidBand:
+				return lowMidPeak;
+			case highMidBand:
+				return highMidPeak;
+			case highShelfBand:
+				return highShelf;
+			default:
+				return highPass;
+			}
+		}
+	};
+
+	void prepare(double sampleRate, int samplesPerBlock, int numChannels)
+	{
+		juce::ignoreUnused(samplesPerBlock);
+		jassert(numChannels <= maxChannels);
+
+		channels = juce::jlimit(1, maxChannels, numChannels);
+		maxTailSamples = maxTailSeconds * sampleRate;
+		fadeStep = (float)(1.0 / (fadeSeconds * sampleRate));
+		useSIMD = BiquadCascade<float>::hasSIMD();
+
+		inputGain.prepare(sampleRate);
+		drive.prepare(sampleRate);
+		outputGain.prepare(sampleRate);
+
+		primary.prepare(sampleRate);
+		side.prepare(sampleRate);
+		midSide = midSideRequested && channels == 2;
+		resendBands = true;
+
+		forEachGroup([sampleRate](auto& group) {
+			for (auto& peak : group.dynamicPeaks)
+				peak.prepare(sampleRate);
+		});
+
+		forEachGroup([](auto& group) { group.reset(); });
+		fades.fill(BandFade());
+		for (auto& eq : linearPhaseEqs)
+			eq.prepare(sampleRate, channels);
+
+		linearPhaseStale.fill(true);
+		outputGainDelay.prepare(linearPhaseEqs[highEq].getLatencyInSamples());
+
+		jumpSvf = true;
+	}
+
+	void reset()
+	{
+		inputGain.reset();
+		drive.reset();
+		outputGain.reset();
+
+		forEachGroup([](auto& group) { group.reset(); });
+		outputGainDelay.reset();
+
+		for (auto& eq : linearPhaseEqs)
+			eq.reset();
+	}
+
+	// Targets for the gain stages, in dB. After the output saturation the
+	// drive is taken back out, all but driveMakeup, as part of the output gain.
+	// Both ramps are straight in dB over the same length, so the pair is one
+	// ramp: drive plus output always sums to outputDecibels + driveMakeup.
+	// In linear phase mode the output ramp runs the latency of the FIR between
+	// the two late, behind the audio it has to match.
+	void setGains(float inputDecibels, float driveDecibels, float outputDecibels)
+	{
+		inputGain.updateGain(inputDecibels);
+		drive.updateGain(driveDecibels);
+		outputGain.updateGain(outputDecibels + driveMakeup - driveDecibels);
+	}
+
+	// Frames are copied into a lane-interleaved tile, run through the whole
+	// chain and copied back, tileSize frames at a time. The tile and all
+	// filter state stay in L1 at any host buffer size.
+	static constexpr int defaultTileSize = 128;
+	static constexpr int maxTileSize = 512;
+
+	void setTileSize(int newTileSize) { tileSize = juce::jlimit(16, maxTileSize, newTileSize); }
+	int getTileSize() const noexcept { return tileSize; }
+
+	// Number of 2x stages around each saturation, 0 to Oversampler::maxStages
+	void setOversampling(int numStages)
+	{
+		forEachGroup([numStages](auto& group) {
+			group.inOversampler.setNumStages(numStages);
+			group.outOversampler.setNumStages(numStages);
+			group.inSideOversampler.setNumStages(numStages);
+			group.outSideOversampler.setNumStages(numStages);
+		});
+	}
+
+	int getOversampling() const noexcept { return floatEngine.groups[0].inOversampler.getNumStages(); }
+
+	void setAntialiasing(SaturationProcessor::Antialiasing antialiasing)
+	{
+		for (auto* stages : { &primary, &side }) {
+			stages->inSaturation.setAntialiasing(antialiasing);
+			stages->outSaturation.setAntialiasing(antialiasing);
+		}
+	}
+
+	// Whole samples of delay added by oversampling, ADAA and the linear phase EQ, for setLatencySamples()
+	int getLatencyInSamples() const
+	{
+		auto& group = floatEngine.groups[0];
+		auto factor = (double)(1 << group.inOversampler.getNumStages());
+
+		auto adaaLatency = [this](const SaturationProcessor& stage, const SaturationProcessor& sideStage) {
+			return usesAntialiasing(stage, sideStage) ? stage.getLatencyInSamples() : 0.0;
+		};
+
+		auto adaa = adaaLatency(primary.inSaturation, side.inSaturation) + adaaLatency(primary.outSaturation, side.outSaturation);
+
+		auto oversampling = group.inOversampler.getLatencyInSamples() + group.outOversampler.getLatencyInSamples();
+		auto eq = 0;
+
+		if (linearPhase)
+			for (auto& linearPhaseEq : linearPhaseEqs)
+				eq += linearPhaseEq.getLatencyInSamples();
+
+		return eq + juce::roundToInt(oversampling + adaa / factor);
+	}
+
+	// Runs the bands as linear phase FIRs, which adds latency
+	void setLinearPhase(bool shouldBeLinearPhase)
+	{
+		if (shouldBeLinearPhase == linearPhase)
+			return;
+
+		// The latency changes anyway, so start both paths from silence
+		linearPhase = shouldBeLinearPhase;
+
+		for (auto& eq : linearPhaseEqs) {
+			eq.setActive(linearPhase);
+			eq.reset();
+		}
+
+		linearPhaseStale.fill(true);
+		outputGainDelay.reset();
+
+		forEachGroup([](auto& group) { group.reset(); });
+	}
+
+	bool isLinearPhase() const noexcept { return linearPhase; }
+
+	// Runs a stereo strip as mid and side, S on the side stages. Other
+	// channel counts stay as they are.
+	void setMidSide(bool shouldBeMidSide)
+	{
+		midSideRequested = shouldBeMidSide;
+
+		if (midSide == (shouldBeMidSide && channels == 2))
+			return;
+
+		midSide = !midSide;
+		resendBands = true;
+
+		forEachGroup([](auto& group) { group.reset(); });
+
+		for (auto& eq : linearPhaseEqs)
+			eq.reset();
+	}
+
+	bool isMidSide() const noexcept { return midSide; }
+
+	// Makes a mid peak dynamic, or static again. band is lowMidBand or
+	// highMidBand. The band has to be redesigned before the next
+	// beginControlInterval() after it is switched.
+	void setDynamics(int band, const DynamicSettings& settings)
+	{
+		auto index = band == highMidBand ? 1 : 0;
+		jassert(band == dynamicBands[index]);
+
+		for (auto* stages : { &primary, &side })
+			(band == highMidBand ? stages->highMidPeak : stages->lowMidPeak).setDynamic(settings.enabled);
+
+		// The form that takes over starts from cleared state, not from
+		// wherever it stopped when it was last switched away
+		auto switched = dynamic[index] != settings.enabled;
+		dynamic[index] = settings.enabled;
+
+		forEachGroup([index, band, switched, &settings](auto& group) {
+			group.dynamicPeaks[index].setDynamics(settings);
+
+			if (switched) {
+				group.filters.resetStage(band);
+				group.svfFilters.resetStage(band);
+				group.dynamicPeaks[index].reset();
+			}
+		});
+	}
+
+	// Samples after the input falls silent until the output and every filter
+	// state are below the denormal threshold, from the current band settings
+	int getTailInSamples() const
+	{
+		auto eq = 0;
+
+		if (linearPhase)
+			for (auto& linearPhaseEq : linearPhaseEqs)
+				eq += linearPhaseEq.getLengthInSamples();
+
+		return eq + (int)std::ceil(bandTail) + getLatencyInSamples();
+	}
+
+	// Switches the EQ bands between the biquad and the SVF cascade. The bands
+	// have to be redesigned before the next beginControlInterval().
+	void setSvfBackend(bool shouldUseSvf)
+	{
+		if (shouldUseSvf == useSvf)
+			return;
+
+		useSvf = shouldUseSvf;
+
+		for (int band = 0; band < numBands; ++band) {
+			primary.getBand(band).setSvfMode(useSvf);
+			side.getBand(band).setSvfMode(useSvf);
+		}
+
+		forEachGroup([this](auto& group) {
+			if (useSvf) {
+				group.svfFilters.reset();
+			} else {
+				group.filters.reset();
+			}
+		});
+
+		jumpSvf = useSvf;
+	}
+
+	bool isSvfBackend() const noexcept { return useSvf; }
+
+	// Hands the bands that were redesigned to the active cascade. Call at
+	// every control tick, after updating the band settings. The SVF cascade
+	// glides to the new settings over the numSamples of the interval.
+	void beginControlInterval(int numSamples)
+	{
+		auto anyChanged = false;
+		bool changed[numBands];
+
+		for (int band = 0; band < numBands; ++band) {
+			changed[band] = takeChanged(band);
+			anyChanged = anyChanged || changed[band];
+		}
+
+		resendBands = false;
+
+		if (useSvf) {
+			forEachGroup([](auto& group) { group.svfFilters.endRamp(); });
+
+			for (int band = 0; band < numBands; ++band)
+				if (changed[band]) {
+					auto parameters = primary.getBand(band).getSvfParameters();
+					auto sideParameters = side.getBand(band).getSvfParameters();
+
+					forEachGroup([this, band, &parameters, &sideParameters](auto& group) {
+						group.svfFilters.setTarget(band, parameters);
+
+						if (midSide)
+							group.svfFilters.setTarget(band, sideParameters, sideLane);
+					});
+				}
+
+			forEachGroup([this, numSamples](auto& group) {
+				if (jumpSvf)
+					group.svfFilters.endRamp();
+
+				group.svfFilters.beginRamp(numSamples);
+			});
+
+			jumpSvf = false;
+		} else {
+			for (int band = 0; band < numBands; ++band)
+				if (changed[band]) {
+					auto* design = primary.getBand(band).getDesign();
+					auto* sideDesign = side.getBand(band).getDesign();
+
+					forEachGroup([this, band, design, sideDesign](auto& group) {
+						group.filters.setCoefficients(band, design);
+
+						if (midSide)
+							group.filters.setCoefficients(band, sideDesign, sideLane);
+					});
+				}
+		}
+
+		// A dynamic peak has the poles of the static one, and its gain as the resting point
+		for (int index = 0; index < numDynamicBands; ++index) {
+			auto band = dynamicBands[index];
+
+			if (!dynamic[index] || !changed[band])
+				continue;
+
+			auto parameters = primary.getBand(band).getSvfParameters();
+			auto sideParameters = side.getBand(band).getSvfParameters();
+
+			forEachGroup([this, index, &parameters, &sideParameters](auto& group) {
+				group.dynamicPeaks[index].setFilter(parameters);
+
+				if (midSide)
+					group.dynamicPeaks[index].setFilter(sideParameters, sideLane);
+			});
+		}
+
+		// The bands run in series, so their decay times add up, the slower of M and S
+		if (anyChanged) {
+			bandTail = 0.0;
+
+			for (int band = 0; band < numBands; ++band) {
+				auto decay = BiquadDesign::getDecaySamples(primary.getBand(band).getDesign(), decayFactor, maxTailSamples);
+
+				if (midSide)
+					decay = juce::jmax(
+						decay, BiquadDesign::getDecaySamples(side.getBand(band).getDesign(), decayFactor, maxTailSamples));
+
+				bandTail += decay;
+			}
+
+			bandTail = juce::jmin(bandTail, maxTailSamples);
+		}
+
+		updateFades();
+
+		// The FIRs are redesigned in the background; a busy designer is asked again next time.
+		// A flat band is left out like in the cascade, and a dynamic peak runs next to its FIR.
+		if (linearPhase) {
+			static constexpr double identity[BiquadDesign::numCoeffs] = { 1.0, 0.0, 0.0, 0.0, 0.0 };
+
+			for (int section = 0; section < numEqSections; ++section) {
+				auto first = eqSectionBands[section], last = eqSectionBands[section + 1];
+
+				if (!linearPhaseStale[section] && std::none_of(changed + first, changed + last, [](bool b) { return b; }))
+					continue;
+
+				const double* designs[LinearPhaseEq::maxBands];
+				const double* sideDesigns[LinearPhaseEq::maxBands];
+
+				for (int band = first; band < last; ++band) {
+					auto dynamicBand = isDynamic(band);
+					auto& primaryBand = primary.getBand(band);
+					auto& sideBand = side.getBand(band);
+
+					designs[band - first] = dynamicBand || primaryBand.isFlat() ? identity : primaryBand.getDesign();
+					sideDesigns[band - first] = dynamicBand || sideBand.isFlat() ? identity : sideBand.getDesign();
+				}
+
+				linearPhaseStale[section]
+					= !linearPhaseEqs[section].requestDesign(last - first, designs, midSide ? sideDesigns : nullptr);
+			}
+		}
+	}
+
+	// Runs the chain over numSamples frames of buffer starting at startSample.
+	// The processor calls this for each part of a control interval, after
+	// beginControlInterval(). SampleType is float or double.
+	//
+	// keyBuffer, when given, is what the dynamic peaks listen to instead of
+	// their own band. A channel without a key channel of its own uses the last.
+	template <typename SampleType>
+	void process(juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples,
+		const juce::AudioBuffer<SampleType>* keyBuffer = nullptr)
+	{
+		auto numChannels = juce::jmin(channels, buffer.getNumChannels());
+		auto* const* data = buffer.getArrayOfWritePointers();
+
+		Key<SampleType> key;
+
+		if (keyBuffer != nullptr && keyBuffer->getNumChannels() > 0 && (dynamic[0] || dynamic[1])) {
+			key.data = keyBuffer->getArrayOfReadPointers();
+			key.numChannels = keyBuffer->getNumChannels();
+		}
+
+		StageTimers::Scope timer(timers, StageTimers::chain, numSamples);
+
+		if (linearPhase) {
+			// The three FIRs are timed together, as one stage
+			auto timeEq = timers != nullptr && timers->isEnabled();
+			juce::int64 eqTicks = 0;
+
+			auto runEq = [&](EqSection section) {
+				auto start = timeEq ? juce::Time::getHighResolutionTicks() : 0;
+				linearPhaseEqs[section].process(data, numChannels, startSample, numSamples);
+
+				if (timeEq)
+					eqTicks += juce::Time::getHighResolutionTicks() - start;
+			};
+
+
+			processGroups<beforeEq>(data, key, numChannels, startSample, numSamples);
+			runEq(lowEq);
+			processGroups<betweenEqs>(data, key, numChannels, startSample, numSamples);
+			runEq(highEq);
+			processGroups<afterEq>(data, key, numChannels, startSample, numSamples);
+			runEq(highPassEq);
+
+			// M and S stay encoded through every FIR
+			if (midSide && numChannels == 2)
+				decodeMidSide(data, startSample, numSamples);
+
+			if (timeEq)
+				timers->addTicks(StageTimers::linearPhaseEq, eqTicks, numSamples);
+		} else {
+			processGroups<wholeChain>(data, key, numChannels, startSample, numSamples);
+		}
+	}
+
+	// Where process() reports the time spent in the chain and in the linear
+	// phase FIRs, while the timers are enabled. nullptr turns it off.
+	void setTimers(StageTimers* newTimers) noexcept { timers = newTimers; }
+
+	// Times every stage on its own over one tile of the first lane group,
+	// for StageTimers. The stages run on copies of their state and on a copy
+	// of the last tile, so the output is not touched. Audio thread only.
+	template <typename SampleType>
+	void probeStages(StageTimers& stageTimers)
+	{
+		auto& engine = getEngine<SampleType>();
+		auto numChannels = juce::jmin(channels, Engine<SampleType>::numLanes);
+
+		if (useSvf) {
+			probeGroup(engine, engine.groups[0].svfFilters, numChannels, stageTimers);
+		} else {
+			probeGroup(engine, engine.groups[0].filters, numChannels, stageTimers);
+		}
+	}
+
+	// The display coefficients of a primary band, or of a side band
+	juce::dsp::IIR::Coefficients<float>* getCoeffs(int filterNum, bool sideBand = false)
+	{
+		if (!juce::isPositiveAndBelow(filterNum, (int)numBands))
+			return nullptr;
+
+		return (sideBand ? side : primary).getBand(filterNum).getCoeffs();
+	}
+
+	FilterBand& getBand(int filterNum) { return primary.getBand(filterNum); }
+
+	// The gains, shared by every channel. Their order in the chain is given
+	// above.
+	GainProcessor inputGain;
+	GainProcessor drive;
+	GainProcessor outputGain;
+
+	// The bands and saturations for every channel, or for M in mid/side mode.
+	// The two saturations hold the settings that every lane group follows.
+	StageSet primary;
+
+	// The same for S in mid/side mode
+	StageSet side;
+
+private:
+	// Net dB of the drive and its offset together
+	static constexpr float driveMakeup = 2.0f;
+
+	// The tail ends once a full scale state has fallen to JUCE_SNAP_TO_ZERO's threshold
+	static constexpr double decayFactor = 1.0e-8;
+	static constexpr double maxTailSeconds = 10.0;
+	double maxTailSamples = 480000.0;
+	double bandTail = 0.0;
+
+	// Fade of a band in or out of the chain, advanced once per frame like the gains.
+	// Long enough that a high pass leaving or rejoining with DC does not click.
+	static constexpr double fadeSeconds = 0.02;
+	float fadeStep = 0.001f;
+
+	struct BandFade {
+		bool running = true;
+		float gain = 1.0f;
+		float step = 0.0f;
+	};
+
+	std::array<BandFade, numBands> fades;
+
+	// Frames of a tile, see setTileSize()
+	int tileSize = defaultTileSize;
+
+	// Per-lane state for one register of channels. The side shapers only run
+	// in mid/side mode.
+	template <typename SampleType>
+	struct LaneGroup {
+		BiquadCascade<SampleType> filters;
+		SvfCascade<SampleType> svfFilters;
+		Oversampler<SampleType> inOversampler, outOversampler;
+		SaturationProcessor inSaturation, outSaturation;
+		Oversampler<SampleType> inSideOversampler, outSideOversampler;
+		SaturationProcessor inSideSaturation, outSideSaturation;
+		DynamicPeak<SampleType> dynamicPeaks[numDynamicBands];
+
+		void reset()
+		{
+			filters.reset();
+			svfFilters.reset();
+			inOversampler.reset();
+			outOversampler.reset();
+			inSaturation.reset();
+			outSaturation.reset();
+			inSideOversampler.reset();
+			outSideOversampler.reset();
+			inSideSaturation.reset();
+			outSideSaturation.reset();
+
+			for (auto& peak : dynamicPeaks)
+				peak.reset();
+		}
+	};
+
+	// All lane groups for one sample type, and the current tile lane-interleaved
+	template <typename SampleType>
+	struct Engine {
+		static constexpr int numLanes = (int)BiquadCascade<SampleType>::numLanes;
+		static constexpr int maxGroups = (maxChannels + numLanes - 1) / numLanes;
+
+		LaneGroup<SampleType> groups[maxGroups];
+		alignas(32) SampleType tile[maxTileSize][numLanes] {};
+		alignas(32) SampleType keyTile[maxTileSize][numLanes] {};
+		alignas(32) SampleType probeTile[maxTileSize][numLanes] {};
+	};
+
+	// The key input of a block, if there is one
+	template <typename SampleType>
+	struct Key {
+		const SampleType* const* data = nullptr;
+		int numChannels = 0;
+	};
+
+	int channels = 2;
+	bool useSIMD = false;
+	bool useSvf = false;
+	bool jumpSvf = true;
+
+	// The linear phase FIRs in the chain, each over the bands from its entry
+	// in eqSectionBands up to the next
+	enum EqSection { lowEq = 0, highEq = 1, highPassEq = 2, numEqSections = 3 };
+	static constexpr int eqSectionBands[numEqSections + 1] = { lowShelfBand, highMidBand, highPassBand, numBands };
+
+	LinearPhaseEq linearPhaseEqs[numEqSections];
+	GainDelay outputGainDelay;
+	bool linearPhase = false;
+	std::array<bool, numEqSections> linearPhaseStale {};
+
+	// Lane of S in mid/side mode, M is lane 0
+	static constexpr size_t sideLane = 1;
+	bool midSideRequested = false;
+	bool midSide = false;
+	bool resendBands = true;
+
+	bool dynamic[numDynamicBands] {};
+
+	StageTimers* timers = nullptr;
+
+	Engine<float> floatEngine;
+	Engine<double> doubleEngine;
+
+	template <typename SampleType>
+	Engine<SampleType>& getEngine() noexcept
+	{
+		if constexpr (std::is_same_v<SampleType, double>)
+			return doubleEngine;
+		else
+			return floatEngine;
+	}
+
+	// Settings reach both engines, so either is ready when the host switches precision
+	template <typename Function>
+	void forEachGroup(Function&& function)
+	{
+		for (auto& group : floatEngine.groups)
+			function(group);
+
+		for (auto& group : doubleEngine.groups)
+			function(group);
+	}
+
+	// Whether a saturation stage runs ADAA at all. A clean curve goes without,
+	// but in mid/side mode only if M and S are both clean, so they keep the
+	// same delay.
+	bool usesAntialiasing(const SaturationProcessor& stage, const SaturationProcessor& sideStage) const noexcept
+	{
+		return !stage.isLinear() || (midSide && !sideStage.isLinear());
+	}
+
+	// The part of the chain a kernel runs. In linear phase mode the FIRs go
+	// after beforeEq, betweenEqs and afterEq.
+	enum Section { wholeChain, beforeEq, betweenEqs, afterEq };
+
+	template <Section section, typename SampleType>
+	void processGroups(SampleType* const* data, const Key<SampleType>& key, int numChannels, int startSample, int numSamples)
+	{
+		auto& engine = getEngine<SampleType>();
+		constexpr int numLanes = Engine<SampleType>::numLanes;
+
+		// Every group sees the same gain ramps; the last one leaves them advanced
+		const auto startInputGain = inputGain, startDrive = drive, startOutputGain = outputGain;
+		const auto startDelayPosition = outputGainDelay.getPosition();
+		const auto startFades = fades;
+		const SampleType* groupKeyData[numLanes] {};
+
+		for (int g = 0; g * numLanes < numChannels; ++g) {
+			auto& group = engine.groups[g];
+			auto groupChannels = juce::jmin(numLanes, numChannels - g * numLanes);
+			auto* groupData = data + g * numLanes;
+
+			inputGain = startInputGain;
+			drive = startDrive;
+			outputGain = startOutputGain;
+			outputGainDelay.setPosition(startDelayPosition);
+			fades = startFades;
+
+			auto inAntialiasing = usesAntialiasing(primary.inSaturation, side.inSaturation);
+			auto outAntialiasing = usesAntialiasing(primary.outSaturation, side.outSaturation);
+
+			group.inSaturation.followSettings(primary.inSaturation);
+			group.outSaturation.followSettings(primary.outSaturation);
+			group.inSaturation.beginBlock(inAntialiasing);
+			group.outSaturation.beginBlock(outAntialiasing);
+
+			if (midSide) {
+				group.inSideSaturation.followSettings(side.inSaturation);
+				group.outSideSaturation.followSettings(side.outSaturation);
+				group.inSideSaturation.beginBlock(inAntialiasing);
+				group.outSideSaturation.beginBlock(outAntialiasing);
+			}
+
+			// The key channels that line up with this group's
+			auto groupKey = key;
+
+			if (key.data != nullptr) {
+				for (int channel = 0; channel < groupChannels; ++channel)
+					groupKeyData[channel] = key.data[juce::jmin(g * numLanes + channel, key.numChannels - 1)];
+
+				groupKey.data = groupKeyData;
+			}
+
+			if (section != wholeChain) {
+				processGroup<section, false>(
+					engine, group, group.filters, groupData, groupKey, groupChannels, startSample, numSamples);
+			} else if (useSvf) {
+				processGroup(engine, group, group.svfFilters, groupData, groupKey, groupChannels, startSample, numSamples);
+			} else {
+				processGroup(engine, group, group.filters, groupData, groupKey, groupChannels, startSample, numSamples);
+			}
+		}
+	}
+
+	// Band fades are rare and short, so the usual kernel leaves them out
+	template <typename SampleType, typename Cascade>
+	void processGroup(Engine<SampleType>& engine, LaneGroup<SampleType>& group, Cascade& cascade, SampleType* const* data,
+		const Key<SampleType>& key, int numChannels, int startSample, int numSamples)
+	{
+		auto fading = std::any_of(fades.begin(), fades.end(), [](const BandFade& fade) { return fade.step != 0.0f; });
+
+		if (fading) {
+			processGroup<wholeChain, true>(engine, group, cascade, data, key, numChannels, startSample, numSamples);
+		} else {
+			processGroup<wholeChain, false>(engine, group, cascade, data, key, numChannels, startSample, numSamples);
+		}
+
+		cascade.snapToZero();
+
+		for (auto& peak : group.dynamicPeaks)
+			peak.snapToZero();
+	}
+
+	// Picks the kernel for the group's channel count, all fixed at compile time
+	template <Section section, bool fading, typename SampleType, typename Cascade>
+	void processGroup(Engine<SampleType>& engine, LaneGroup<SampleType>& group, Cascade& cascade, SampleType* const* data,
+		const Key<SampleType>& key, int numChannels, int startSample, int numSamples)
+	{
+		using MonoLanes = ScalarLanes<SampleType, 1>;
+		using StereoFallbackLanes = ScalarLanes<SampleType, 2>;
+
+		if (numChannels == 1) {
+			processFrames<MonoLanes, section, fading>(engine, group, cascade, data, key, numChannels, startSample, numSamples);
+		} else if (useSIMD) {
+			processFrames<typename Cascade::SIMDLanes, section, fading>(
+				engine, group, cascade, data, key, numChannels, startSample, numSamples);
+		} else if (numChannels == 2) {
+			processFrames<StereoFallbackLanes, section, fading>(
+				engine, group, cascade, data, key, numChannels, startSample, numSamples);
+		} else {
+			processFrames<typename Cascade::FallbackLanes, section, fading>(
+				engine, group, cascade, data, key, numChannels, startSample, numSamples);
+		}
+	}
+
+	template <typename Lanes, Section section, bool fading, typename SampleType, typename Cascade>
+	void processFrames(Engine<SampleType>& engine, LaneGroup<SampleType>& group, Cascade& bands, SampleType* const* data,
+		const Key<SampleType>& key, int numChannels, int startSample, int numSamples)
+	{
+		using Peak = typename DynamicPeak<SampleType>::template Registers<Lanes>;
+
+		using Shaper = typename Oversampler<SampleType>::template Registers<Lanes>;
+
+		auto& tile = engine.tile;
+		auto& keyTile = engine.keyTile;
+		typename Cascade::template Registers<Lanes> cascade(bands);
+		Shaper inShaper(group.inOversampler), outShaper(group.outOversampler);
+		auto bandFades = fades;
+
+		// Between the linear phase FIRs the peaks run only when dynamic, and without the key
+		Peak lowMidDynamics(group.dynamicPeaks[0]), highMidDynamics(group.dynamicPeaks[1]);
+		auto keyed = section == wholeChain && key.data != nullptr;
+
+		// The FIRs run on M and S, so those are decoded only after the last, by process()
+		auto splitLanes = midSide && numChannels == 2;
+		auto encode = splitLanes && (section == wholeChain || section == beforeEq);
+		auto decode = splitLanes && section == wholeChain;
+
+		std::optional<SideShaper<SampleType>> inSideShaper, outSideShaper;
+
+		if (splitLanes) {
+			inSideShaper.emplace(group.inSideOversampler, sideLane);
+			outSideShaper.emplace(group.outSideOversampler, sideLane);
+		}
+
+		auto peak = [&](Peak& dynamics, int band, int frame, Lanes x) {
+			if (!dynamics.isActive())
+				return processBand<fading>(cascade, bandFades[band], band, x);
+
+			return keyed ? dynamics.process(x, Lanes::fromRawArray(keyTile[frame])) : dynamics.process(x);
+		};
+
+		for (int tileStart = startSample; tileStart < startSample + numSamples; tileStart += tileSize) {
+			auto tileLength = juce::jmin(tileSize, startSample + numSamples - tileStart);
+
+			if (encode) {
+				auto* left = data[0] + tileStart;
+				auto* right = data[1] + tileStart;
+
+				for (int i = 0; i < tileLength; ++i) {
+					tile[i][0] = (SampleType)0.5 * (left[i] + right[i]);
+					tile[i][sideLane] = (SampleType)0.5 * (left[i] - right[i]);
+				}
+			} else {
+				for (int channel = 0; channel < numChannels; ++channel) {
+					auto* source = data[channel] + tileStart;
+
+					for (int i = 0; i < tileLength; ++i)
+						tile[i][channel] = source[i];
+				}
+			}
+
+			for (int channel = numChannels; channel < (int)Lanes::SIMDNumElements; ++channel)
+				for (int i = 0; i < tileLength; ++i)
+					tile[i][channel] = SampleType();
+
+			// The key goes through the same encoding as the signal
+			if (keyed)
+				fillKeyTile(keyTile, key, encode, numChannels, tileStart, tileLength);
+
+			for (int i = 0; i < tileLength; ++i) {
+				auto x = Lanes::fromRawArray(tile[i]);
+
+				if constexpr (section == wholeChain) {
+					x *= Lanes::expand((SampleType)inputGain.getNextGain());
+					x = shapeFrame(inShaper, inSideShaper, group.inSaturation, group.inSideSaturation, x);
+					x = processBand<fading>(cascade, bandFades[lowShelfBand], lowShelfBand, x);
+					x = peak(lowMidDynamics, lowMidBand, i, x);
+					x *= Lanes::expand((SampleType)drive.getNextGain());
+					x = peak(highMidDynamics, highMidBand, i, x);
+					x = processBand<fading>(cascade, bandFades[highShelfBand], highShelfBand, x);
+					x = shapeFrame(outShaper, outSideShaper, group.outSaturation, group.outSideSaturation, x);
+					x *= Lanes::expand((SampleType)outputGain.getNextGain());
+					x = processBand<fading>(cascade, bandFades[highPassBand], highPassBand, x);
+				} else if constexpr (section == beforeEq) {
+					x *= Lanes::expand((SampleType)inputGain.getNextGain());
+					x = shapeFrame(inShaper, inSideShaper, group.inSaturation, group.inSideSaturation, x);
+				} else if constexpr (section == betweenEqs) {
+					if (lowMidDynamics.isActive())
+						x = lowMidDynamics.process(x);
+
+					x *= Lanes::expand((SampleType)drive.getNextGain());
+
+					if (highMidDynamics.isActive())
+						x = highMidDynamics.process(x);
+				} else {
+					x = shapeFrame(outShaper, outSideShaper, group.outSaturation, group.outSideSaturation, x);
+					x *= Lanes::expand((SampleType)outputGainDelay.process(outputGain.getNextGain()));
+				}
+
+				x.copyToRawArray(tile[i]);
+			}
+
+			if (decode) {
+				auto* left = data[0] + tileStart;
+				auto* right = data[1] + tileStart;
+
+				for (int i = 0; i < tileLength; ++i) {
+					left[i] = tile[i][0] + tile[i][sideLane];
+					right[i] = tile[i][0] - tile[i][sideLane];
+				}
+			} else {
+				for (int channel = 0; channel < numChannels; ++channel) {
+					auto* destination = data[channel] + tileStart;
+
+					for (int i = 0; i < tileLength; ++i)
+						destination[i] = tile[i][channel];
+				}
+			}
+		}
+
+		fades = bandFades;
+		cascade.store(bands);
+		lowMidDynamics.store(group.dynamicPeaks[0]);
+		highMidDynamics.store(group.dynamicPeaks[1]);
+		inShaper.store(group.inOversampler);
+		outShaper.store(group.outOversampler);
+
+		if (splitLanes) {
+			inSideShaper->store(group.inSideOversampler);
+			outSideShaper->store(group.outSideOversampler);
+		}
+	}
+
+	// The side shapers run S alone, from its lane of the side oversamplers
+	template <typename SampleType>
+	using SideShaper = typename Oversampler<SampleType>::template Registers<ScalarLanes<SampleType, 1>>;
+
+	// One saturation stage for a frame. In mid/side mode, when there are side
+	// shapers, S is then run through the side stage by itself.
+	template <typename Shaper, typename Side, typename Lanes>
+	static Lanes shapeFrame(Shaper& shaper, std::optional<Side>& sideShaper, SaturationProcessor& saturation,
+		SaturationProcessor& sideSaturation, Lanes x) noexcept
+	{
+		auto y = shaper.process(saturation, x);
+
+		if (sideShaper.has_value()) {
+			// sideLane, kept in range for the one lane kernel, which never gets here
+			constexpr auto lane = sideLane % Lanes::SIMDNumElements;
+			auto s = sideShaper->process(sideSaturation, ScalarLanes<typename Lanes::ElementType, 1>::expand(x.get(lane)));
+			y.set(lane, s.get(0));
+		}
+
+		return y;
+	}
+
+	// Picks the lanes for probeStages() the way processGroup() does
+	template <typename SampleType, typename Cascade>
+	void probeGroup(Engine<SampleType>& engine, const Cascade& cascade, int numChannels, StageTimers& stageTimers)
+	{
+		if (numChannels == 1) {
+			probeFrames<ScalarLanes<SampleType, 1>>(engine, cascade, numChannels, stageTimers);
+		} else if (useSIMD) {
+			probeFrames<typename Cascade::SIMDLanes>(engine, cascade, numChannels, stageTimers);
+		} else if (numChannels == 2) {
+			probeFrames<ScalarLanes<SampleType, 2>>(engine, cascade, numChannels, stageTimers);
+		} else {
+			probeFrames<typename Cascade::FallbackLanes>(engine, cascade, numChannels, stageTimers);
+		}
+	}
+
+	template <typename Lanes, typename SampleType, typename Cascade>
+	void probeFrames(Engine<SampleType>& engine, const Cascade& bands, int numChannels, StageTimers& stageTimers)
+	{
+		using Shaper = typename Oversampler<SampleType>::template Registers<Lanes>;
+		using Peak = typename DynamicPeak<SampleType>::template Registers<Lanes>;
+
+		auto& group = engine.groups[0];
+		auto& probe = engine.probeTile;
+		std::copy(&engine.tile[0][0], &engine.tile[0][0] + maxTileSize * Engine<SampleType>::numLanes, &probe[0][0]);
+
+		// Copies of everything a stage changes as it runs
+		auto in = inputGain, driveGain = drive, out = outputGain;
+		auto lowMidPeak = group.dynamicPeaks[0], highMidPeak = group.dynamicPeaks[1];
+		typename Cascade::template Registers<Lanes> cascade(bands);
+		Shaper inShaper(group.inOversampler), outShaper(group.outOversampler);
+		Peak lowMidDynamics(lowMidPeak), highMidDynamics(highMidPeak);
+
+		SaturationProcessor* saturations[] = { &group.inSaturation, &group.outSaturation, &group.inSideSaturation,
+			&group.outSideSaturation };
+		SaturationProcessor::History histories[4];
+
+		for (int i = 0; i < 4; ++i)
+			histories[i] = saturations[i]->getHistory();
+
+		std::optional<SideShaper<SampleType>> inSideShaper, outSideShaper;
+
+		if (midSide && numChannels == 2) {
+			inSideShaper.emplace(group.inSideOversampler, sideLane);
+			outSideShaper.emplace(group.outSideOversampler, sideLane);
+		}
+
+		// A stage that does not run this block adds no sample at all
+		auto time = [&](StageTimers::Stage stage, bool runs, auto&& process) {
+			if (!runs)
+				return;
+
+			StageTimers::Scope timer(stageTimers, stage, tileSize);
+
+			for (int i = 0; i < tileSize; ++i)
+				process(Lanes::fromRawArray(probe[i])).copyToRawArray(probe[i]);
+		};
+
+		// In linear phase mode only a dynamic peak runs outside the FIRs
+		auto runs = [this](int band) {
+			if (linearPhase)
+				return isDynamic(band);
+
+			return fades[band].running;
+		};
+		auto peak = [&](Peak& dynamics, int band, Lanes x) {
+			return dynamics.isActive() ? dynamics.process(x) : cascade.processStage(band, x);
+		};
+
+		time(StageTimers::inputGain, true, [&](Lanes x) { return x * Lanes::expand((SampleType)in.getNextGain()); });
+		time(StageTimers::inSaturation, true, [&](Lanes x) {
+			return shapeFrame(inShaper, inSideShaper, group.inSaturation, group.inSideSaturation, x);
+		});
+		time(StageTimers::lowShelf, runs(lowShelfBand), [&](Lanes x) { return cascade.processStage(lowShelfBand, x); });
+		time(StageTimers::lowMidPeak, runs(lowMidBand), [&](Lanes x) { return peak(lowMidDynamics, lowMidBand, x); });
+		time(StageTimers::drive, true, [&](Lanes x) { return x * Lanes::expand((SampleType)driveGain.getNextGain()); });
+		time(StageTimers::highMidPeak, runs(highMidBand), [&](Lanes x) { return peak(highMidDynamics, highMidBand, x); });
+		time(StageTimers::highShelf, runs(highShelfBand), [&](Lanes x) { return cascade.processStage(highShelfBand, x); });
+		time(StageTimers::outSaturation, true, [&](Lanes x) {
+			return shapeFrame(outShaper, outSideShaper, group.outSaturation, group.outSideSaturation, x);
+		});
+		time(StageTimers::outputGain, true, [&](Lanes x) { return x * Lanes::expand((SampleType)out.getNextGain()); });
+		time(StageTimers::highPass, runs(highPassBand), [&](Lanes x) { return cascade.processStage(highPassBand, x); });
+
+		for (int i = 0; i < 4; ++i)
+			saturations[i]->setHistory(histories[i]);
+	}
+
+	// Back from M and S to left and right, after the last linear phase FIR
+	template <typename SampleType>
+	static void decodeMidSide(SampleType* const* data, int startSample, int numSamples) noexcept
+	{
+		auto* left = data[0] + startSample;
+		auto* right = data[1] + startSample;
+
+		for (int i = 0; i < numSamples; ++i) {
+			auto mid = left[i], sideSample = right[i];
+			left[i] = mid + sideSample;
+			right[i] = mid - sideSample;
+		}
+	}
+
+	template <typename SampleType, typename Tile>
+	static void fillKeyTile(
+		Tile& keyTile, const Key<SampleType>& key, bool encode, int numChannels, int tileStart, int tileLength)
+	{
+		if (encode) {
+			auto* left = key.data[0] + tileStart;
+			auto* right = key.data[1] + tileStart;
+
+			for (int i = 0; i < tileLength; ++i) {
+				keyTile[i][0] = (SampleType)0.5 * (left[i] + right[i]);
+				keyTile[i][sideLane] = (SampleType)0.5 * (left[i] - right[i]);
+			}
+		} else {
+			for (int channel = 0; channel < numChannels; ++channel) {
+				auto* source = key.data[channel] + tileStart;
+
+				for (int i = 0; i < tileLength; ++i)
+					keyTile[i][channel] = source[i];
+			}
+		}
+	}
+
+	// A stage of the cascade, skipped while bypassed and mixed with its input while fading
+	template <bool fading, typename Lanes, typename Registers>
+	static Lanes processBand(Registers& cascade, BandFade& fade, int band, Lanes x) noexcept
+	{
+		if (!fade.running)
+			return x;
+
+		auto y = cascade.processStage(band, x);
+
+		if (!fading || fade.step == 0.0f)
+			return y;
+
+		y = x + (y - x) * Lanes::expand((typename Lanes::ElementType)fade.gain);
+		fade.gain = juce::jlimit(0.0f, 1.0f, fade.gain + fade.step);
+
+		return y;
+	}
+
+	// True for a mid peak that is set to be dynamic
+	bool isDynamic(int band) const noexcept
+	{
+		return (band == lowMidBand && dynamic[0]) || (band == highMidBand && dynamic[1]);
+	}
+
+	// Takes the changed flags of both sets; a side band only counts in
+	// mid/side mode
+	bool takeChanged(int band)
+	{
+		auto sideChanged = side.getBand(band).takeChanged();
+		auto changed = primary.getBand(band).takeChanged();
+
+		return changed || (midSide && sideChanged) || resendBands;
+	}
+
+	// Ends the fades that are done, then fades out bands that went flat and
+	// fades in, from cleared state, bands that moved again. A band changes
+	// direction mid-fade without a jump.
+	void updateFades()
+	{
+		for (int band = 0; band < numBands; ++band) {
+			auto& fade = fades[band];
+
+			if ((fade.step < 0.0f && fade.gain <= 0.0f) || (fade.step > 0.0f && fade.gain >= 1.0f)) {
+				fade.running = fade.step > 0.0f;
+				fade.step = 0.0f;
+			}
+
+			// A dynamic peak can move away from flat at any moment
+			auto dynamicBand = isDynamic(band);
+			auto flat = primary.getBand(band).isFlat() && (!midSide || side.getBand(band).isFlat()) && !dynamicBand;
+
+			if (flat && fade.running) {
+				fade.step = -fadeStep;
+			} else if (!flat && fade.step < 0.0f) {
+				fade.step = fadeStep;
+			} else if (!flat && !fade.running) {
+				forEachGroup([band](auto& group) {
+					group.filters.resetStage(band);
+					group.svfFilters.resetStage(band);
+				});
+
+				fade.running = true;
+				fade.gain = 0.0f;
+				fade.step = fadeStep;
+			}
+		}
+	}
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelStrip)
+};
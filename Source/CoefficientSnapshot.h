@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    CoefficientSnapshot.h
+    Created: 17 Oct 2026 9:48:22pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadDesign.h"
+
+//==============================================================================
+// The display coefficients of every band, handed from the audio thread to
+// the editor through a seqlock. The audio thread never waits; a reader that
+// overlaps a publish just reads again. Each publish bumps a version, so the
+// editor can tell a change from one atomic load.
+class CoefficientSnapshot {
+public:
+	static constexpr int numSets = 2;
+	static constexpr int numBands = 5;
+	static constexpr int numCoeffs = BiquadDesign::numCoeffs;
+
+	// (b0, b1, b2, a1, a2) per band, for the primary and the side stages
+	struct Coefficients {
+		float bands[numSets][numBands][numCoeffs];
+
+		bool operator==(const Coefficients&) const = default;
+	};
+
+	CoefficientSnapshot()
+	{
+		for (auto& value : values)
+			value.store(0.0f, std::memory_order_relaxed);
+
+		for (int set = 0; set < numSets; ++set)
+			for (int band = 0; band < numBands; ++band)
+				values[index(set, band, 0)].store(1.0f, std::memory_order_relaxed);
+	}
+
+	// Audio thread only
+	void publish(const Coefficients& coefficients) noexcept
+	{
+		auto sequence = counter.load(std::memory_order_relaxed);
+
+		// Odd while the values are being written
+		counter.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (int set = 0; set < numSets; ++set)
+			for (int band = 0; band < numBands; ++band)
+				for (int coeff = 0; coeff < numCoeffs; ++coeff)
+					values[index(set, band, coeff)].store(coefficients.bands[set][band][coeff], std::memory_order_relaxed);
+
+		counter.store(sequence + 2, std::memory_order_release);
+	}
+
+	// Goes up by one with every publish()
+	juce::uint32 getVersion() const noexcept { return counter.load(std::memory_order_acquire) / 2; }
+
+	// Any thread. Returns the version that was read.
+	juce::uint32 read(Coefficients& coefficients) const noexcept
+	{
+		for (;;) {
+			auto before = counter.load(std::memory_order_acquire);
+
+			if ((before & 1) != 0) {
+				juce::Thread::yield();
+				continue;
+			}
+
+			for (int set = 0; set < numSets; ++set)
+				for (int band = 0; band < numBands; ++band)
+					for (int coeff = 0; coeff < numCoeffs; ++coeff)
+						coefficients.bands[set][band][coeff] = values[index(set, band, coeff)].load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (counter.load(std::memory_order_relaxed) == before)
+				return before / 2;
+		}
+	}
+
+private:
+	std::atomic<juce::uint32> counter { 0 };
+	std::atomic<float> values[numSets * numBands * numCoeffs];
+
+	static constexpr int index(int set, int band, int coeff) noexcept
+	{
+		return (set * numBands + band) * numCoeffs + coeff;
+	}
+
+	JUCE_DECLARE_NON_COPYABLE(CoefficientSnapshot)
+};
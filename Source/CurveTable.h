@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    CurveTable.h
+    Created: 17 Oct 2026 4:52:09pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// A saturation curve as a table of cubic pieces across [-range, range],
+// continued past either end as a straight line with the curve's asymptotic
+// slope. Each cell holds the piece's polynomial in the cell position t:
+//
+//   y = c0 + t (c1 + t (c2 + t c3)),  0 <= t <= 1
+//
+// One cell is one aligned 16 byte record, so each lane reads a single block
+// instead of gathering four values from four arrays.
+//
+// The cells are either built in memory or mapped read-only from a .j13curve
+// file, whose layout is FileHeader followed directly by the cells.
+class CurveTable {
+public:
+	struct alignas(16) Cell {
+		float c[4];
+	};
+
+	struct FileHeader {
+		char magic[4]; // "J13C"
+		juce::uint32 version;
+		juce::uint32 numCells;
+		float range;
+		float slope;
+		juce::uint32 reserved[3];
+	};
+
+	static_assert(sizeof(FileHeader) % sizeof(Cell) == 0, "cells must stay aligned in a mapped file");
+
+	static constexpr juce::uint32 fileVersion = 1;
+
+	// Samples curve (double -> double) at numCells + 1 knots and joins them with
+	// Hermite cubics. Slopes are one-sided differences from inside each cell, so
+	// a kink that falls on a knot stays sharp.
+	template <typename Curve>
+	CurveTable(Curve curve, double tableRange, int tableCells, double asymptoticSlope)
+		: numCells(tableCells)
+		, range((float)tableRange)
+		, slope((float)asymptoticSlope)
+	{
+		ownedCells.resize((size_t)numCells);
+
+		auto step = 2.0 * tableRange / numCells;
+		auto knot = [&](int i) { return -tableRange + i * step; };
+		auto derivative = [&](double x, double h) {
+			return (4.0 * curve(x + h) - curve(x + 2.0 * h) - 3.0 * curve(x)) / (2.0 * h);
+		};
+
+		for (int i = 0; i < numCells; ++i) {
+			auto y0 = curve(knot(i)), y1 = curve(knot(i + 1));
+			auto m0 = step * derivative(knot(i), 1.0e-5), m1 = step * derivative(knot(i + 1), -1.0e-5);
+
+			auto& cell = ownedCells[(size_t)i];
+			cell.c[0] = (float)y0;
+			cell.c[1] = (float)m0;
+			cell.c[2] = (float)(3.0 * (y1 - y0) - 2.0 * m0 - m1);
+			cell.c[3] = (float)(2.0 * (y0 - y1) + m0 + m1);
+		}
+
+		cells = ownedCells.data();
+		updateScale();
+	}
+
+	// Maps a .j13curve file. Check isValid() afterwards.
+	explicit CurveTable(const juce::File& file)
+		: mapping(std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly))
+	{
+		auto* data = static_cast<const char*>(mapping->getData());
+		auto size = mapping->getSize();
+
+		if (data == nullptr || size < sizeof(FileHeader))
+			return;
+
+		FileHeader header;
+		std::memcpy(&header, data, sizeof(header));
+
+		if (std::memcmp(header.magic, "J13C", 4) != 0 || header.version != fileVersion || header.numCells == 0
+			|| size < sizeof(FileHeader) + header.numCells * sizeof(Cell) || !std::isfinite(header.range) || header.range <= 0.0f
+			|| !std::isfinite(header.slope))
+			return;
+
+		numCells = (int)header.numCells;
+		range = header.range;
+		slope = header.slope;
+		cells = reinterpret_cast<const Cell*>(data + sizeof(FileHeader));
+		updateScale();
+	}
+
+	bool isValid() const noexcept { return cells != nullptr; }
+
+	// Writes the table in the layout the file constructor maps
+	bool saveToFile(const juce::File& file) const
+	{
+		if (!isValid())
+			return false;
+
+		FileHeader header {};
+		std::memcpy(header.magic, "J13C", 4);
+		header.version = fileVersion;
+		header.numCells = (juce::uint32)numCells;
+		header.range = range;
+		header.slope = slope;
+
+		juce::FileOutputStream out(file);
+
+		if (!out.openedOk())
+			return false;
+
+		out.setPosition(0);
+		out.truncate();
+
+		return out.write(&header, sizeof(header)) && out.write(cells, (size_t)numCells * sizeof(Cell));
+	}
+
+	template <typename Lanes>
+	Lanes process(Lanes x) const noexcept
+	{
+		using Element = typename Lanes::ElementType;
+
+		auto limit = Lanes::expand((Element)range);
+		auto clamped = Lanes::min(Lanes::max(x, Lanes::expand(Element()) - limit), limit);
+
+		auto position = (clamped + limit) * Lanes::expand((Element)scale);
+		auto index = Lanes::min(Lanes::truncate(position), Lanes::expand((Element)(numCells - 1)));
+		auto t = position - index;
+
+		alignas(16) Element c[4][Lanes::SIMDNumElements];
+
+		for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane) {
+			// A NaN fails the compare, and reads the first cell rather than an undefined one
+			auto cellIndex = index.get(lane);
+			auto& cell = cells[cellIndex >= Element() ? (int)cellIndex : 0];
+
+			for (int k = 0; k < 4; ++k)
+				c[k][lane] = cell.c[k];
+		}
+
+		auto y = Lanes::fromRawArray(c[3]);
+		y = y * t + Lanes::fromRawArray(c[2]);
+		y = y * t + Lanes::fromRawArray(c[1]);
+		y = y * t + Lanes::fromRawArray(c[0]);
+
+		return y + Lanes::expand((Element)slope) * (x - clamped);
+	}
+
+	// Scalar version in double, e.g. for building antiderivatives of a user curve
+	double evaluate(double x) const noexcept
+	{
+		auto clamped = juce::jlimit(-(double)range, (double)range, x);
+		auto position = (clamped + range) * scale;
+		auto i = juce::jmin((int)position, numCells - 1);
+		auto t = position - i;
+		auto& c = cells[i].c;
+
+		return c[0] + t * (c[1] + t * (c[2] + t * c[3])) + slope * (x - clamped);
+	}
+
+	double getAsymptoticSlope() const noexcept { return slope; }
+
+private:
+	int numCells = 0;
+	float range = 1.0f;
+	float slope = 0.0f;
+	float scale = 0.0f;
+
+	const Cell* cells = nullptr;
+	std::vector<Cell> ownedCells;
+	std::unique_ptr<juce::MemoryMappedFile> mapping;
+
+	void updateScale() noexcept { scale = (float)numCells / (2.0f * range); }
+
+	JUCE_DECLARE_NON_COPYABLE(CurveTable)
+};
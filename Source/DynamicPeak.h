@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.h
+    Created: 17 Oct 2026 6:41:18pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+#include "FastMath.h"
+#include "SvfFilter.h"
+
+//==============================================================================
+// Threshold and ratio of a dynamic band in dB, attack and release in ms
+struct DynamicSettings {
+	bool enabled = false;
+	float threshold = -24.0f;
+	float ratio = 2.0f;
+	float attack = 5.0f;
+	float release = 100.0f;
+};
+
+//==============================================================================
+// A peak band whose gain follows the level in its own band. The filter is
+// the SVF peak of SvfDesign written as
+//
+//   out = in + m1 band,  m1 = k (gain - 1)
+//
+// with the poles fixed at the static setting, so only m1 moves with the
+// envelope. That is one multiply per sample; the poles never change and the
+// band cannot blow up however fast it is modulated.
+//
+// The detector is the same band, k band, of the input or of a key signal.
+// The gain computer needs a log and an exp, so it runs every gainInterval
+// samples and m1 is ramped linearly in between. Above the threshold the
+// band is turned down by (1 - 1 / ratio) of the overshoot, in dB.
+template <typename SampleType>
+class DynamicPeak {
+public:
+	static constexpr size_t numLanes = BiquadCascade<SampleType>::numLanes;
+	static constexpr int gainInterval = 16;
+
+	DynamicPeak()
+	{
+		std::fill(reduction, reduction + numLanes, (SampleType)1);
+		setFilter(SvfParameters());
+		reset();
+	}
+
+	void prepare(double newSampleRate)
+	{
+		sampleRate = newSampleRate;
+		setDynamics(settings);
+		reset();
+	}
+
+	// Turning the band on or off clears it, as the static band has other state
+	void setDynamics(const DynamicSettings& newSettings)
+	{
+		if (newSettings.enabled != settings.enabled)
+			reset();
+
+		settings = newSettings;
+		slope = (SampleType)(1.0 - 1.0 / juce::jmax(1.0f, settings.ratio));
+		attack = (SampleType)smoothing(settings.attack);
+		release = (SampleType)smoothing(settings.release);
+	}
+
+	bool isActive() const noexcept { return settings.enabled; }
+
+	// A static SvfDesign::makePeakFilter() setting, for every lane
+	void setFilter(const SvfParameters& p)
+	{
+		for (size_t lane = 0; lane < numLanes; ++lane)
+			setFilter(p, lane);
+	}
+
+	// The same for a single lane, e.g. the side channel in mid/side mode
+	void setFilter(const SvfParameters& p, size_t lane)
+	{
+		auto a1 = 1.0 / (1.0 + p.g * (p.g + p.k));
+
+		coeffs[a1Coeff][lane] = (SampleType)a1;
+		coeffs[a2Coeff][lane] = (SampleType)(p.g * a1);
+		coeffs[a3Coeff][lane] = (SampleType)(p.g * p.g * a1);
+		coeffs[kCoeff][lane] = (SampleType)p.k;
+
+		// The peak's centre gain, 1 + m1 / k
+		staticGain[lane] = (SampleType)(1.0 + p.m1 / p.k);
+
+		// Keeps the gain reduction it has, at the new setting
+		m1[lane] = (SampleType)p.k * (staticGain[lane] * reduction[lane] - (SampleType)1);
+		m1Step[lane] = SampleType();
+	}
+
+	void reset()
+	{
+		for (auto* lanes : { state[0], state[1], keyState[0], keyState[1], envelope, m1Step })
+			std::fill(lanes, lanes + numLanes, SampleType());
+
+		std::fill(reduction, reduction + numLanes, (SampleType)1);
+
+		for (size_t lane = 0; lane < numLanes; ++lane)
+			m1[lane] = coeffs[kCoeff][lane] * (staticGain[lane] - (SampleType)1);
+
+		countdown = 0;
+	}
+
+	void snapToZero() noexcept
+	{
+		for (auto* lanes : { state[0], state[1], keyState[0], keyState[1], envelope })
+			for (size_t lane = 0; lane < numLanes; ++lane)
+				JUCE_SNAP_TO_ZERO(lanes[lane]);
+	}
+
+	//==========================================================================
+	// Register copy for the length of one segment, see BiquadCascade::Registers.
+	// Nothing is loaded while the band is static.
+	template <typename Lanes>
+	class Registers {
+	public:
+		explicit Registers(DynamicPeak& peak)
+			: active(peak.isActive())
+			, gainComputer(peak)
+		{
+			if (!active)
+				return;
+
+			a1 = Lanes::fromRawArray(peak.coeffs[a1Coeff]);
+			a2 = Lanes::fromRawArray(peak.coeffs[a2Coeff]);
+			a3 = Lanes::fromRawArray(peak.coeffs[a3Coeff]);
+			k = Lanes::fromRawArray(peak.coeffs[kCoeff]);
+			attack = Lanes::expand(peak.attack);
+			release = Lanes::expand(peak.release);
+
+			m1 = Lanes::fromRawArray(peak.m1);
+			m1Step = Lanes::fromRawArray(peak.m1Step);
+			envelope = Lanes::fromRawArray(peak.envelope);
+			ic1eq = Lanes::fromRawArray(peak.state[0]);
+			ic2eq = Lanes::fromRawArray(peak.state[1]);
+			key1eq = Lanes::fromRawArray(peak.keyState[0]);
+			key2eq = Lanes::fromRawArray(peak.keyState[1]);
+		}
+
+		void store(DynamicPeak& peak) const
+		{
+			if (!active)
+				return;
+
+			m1.copyToRawArray(peak.m1);
+			m1Step.copyToRawArray(peak.m1Step);
+			envelope.copyToRawArray(peak.envelope);
+			ic1eq.copyToRawArray(peak.state[0]);
+			ic2eq.copyToRawArray(peak.state[1]);
+			key1eq.copyToRawArray(peak.keyState[0]);
+			key2eq.copyToRawArray(peak.keyState[1]);
+		}
+
+		bool isActive() const noexcept { return active; }
+
+		// Detects on the band itself
+		Lanes process(Lanes x) noexcept
+		{
+			nextGain();
+
+			auto band = runBand(x, ic1eq, ic2eq);
+			detect(k * band);
+
+			return output(x, band);
+		}
+
+		// Detects on the same band of a key signal
+		Lanes process(Lanes x, Lanes key) noexcept
+		{
+			nextGain();
+
+			detect(k * runBand(key, key1eq, key2eq));
+
+			return output(x, runBand(x, ic1eq, ic2eq));
+		}
+
+	private:
+		bool active;
+		DynamicPeak& gainComputer;
+
+		Lanes a1, a2, a3, k, attack, release;
+		Lanes m1, m1Step, envelope;
+		Lanes ic1eq, ic2eq, key1eq, key2eq;
+
+		// Band pass output of a TPT SVF, see SvfCascade
+		Lanes runBand(Lanes x, Lanes& s1, Lanes& s2) const noexcept
+		{
+			auto v3 = x - s2;
+			auto v1 = a1 * s1 + a2 * v3;
+			auto v2 = s2 + a2 * s1 + a3 * v3;
+
+			s1 = v1 + v1 - s1;
+			s2 = v2 + v2 - s2;
+
+			return v1;
+		}
+
+		// Peak follower, attack while rising and release while falling, without a branch
+		void detect(Lanes level) noexcept
+		{
+			level = FastMath::abs(level);
+
+			auto rise = Lanes::max(level, envelope) - envelope;
+			auto fall = Lanes::min(level, envelope) - envelope;
+
+			envelope += rise * attack + fall * release;
+		}
+
+		Lanes output(Lanes x, Lanes band) noexcept
+		{
+			auto y = x + m1 * band;
+			m1 += m1Step;
+
+			return y;
+		}
+
+		void nextGain() noexcept
+		{
+			if (gainComputer.countdown == 0) {
+				gainComputer.updateGain(envelope, m1, m1Step);
+				gainComputer.countdown = gainInterval;
+			}
+
+			--gainComputer.countdown;
+		}
+	};
+
+private:
+	enum { a1Coeff = 0, a2Coeff, a3Coeff, kCoeff, numCoeffs };
+
+	double sampleRate = 44100.0;
+	DynamicSettings settings;
+	SampleType slope = SampleType();
+	SampleType attack = (SampleType)1;
+	SampleType release = (SampleType)1;
+	int countdown = 0;
+
+	alignas(32) SampleType coeffs[numCoeffs][numLanes] {};
+	alignas(32) SampleType staticGain[numLanes] {};
+	alignas(32) SampleType reduction[numLanes] {};
+	alignas(32) SampleType m1[numLanes] {};
+	alignas(32) SampleType m1Step[numLanes] {};
+	alignas(32) SampleType envelope[numLanes] {};
+	alignas(32) SampleType state[2][numLanes] {};
+	alignas(32) SampleType keyState[2][numLanes] {};
+
+	// One pole coefficient that covers 1 - 1/e of a step in milliseconds
+	double smoothing(float milliseconds) const
+	{
+		return 1.0 - std::exp(-1.0 / (juce::jmax(0.01, (double)milliseconds) * 0.001 * sampleRate));
+	}
+
+	// The gain computer, lane by lane, and a ramp of m1 to it over the next interval
+	template <typename Lanes>
+	void updateGain(const Lanes& level, const Lanes& current, Lanes& step) noexcept
+	{
+		// ln(10) / 20, from dB to the exponent of e
+		constexpr double decibelsToNepers = 0.115129254649702284;
+
+		for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane) {
+			auto levelDecibels = 20.0 * std::log10(juce::jmax(1.0e-9, (double)level.get(lane)));
+			auto over = juce::jmax(0.0, levelDecibels - (double)settings.threshold);
+			reduction[lane] = (SampleType)std::exp(-over * (double)slope * decibelsToNepers);
+
+			auto target = coeffs[kCoeff][lane] * (staticGain[lane] * reduction[lane] - (SampleType)1);
+			step.set(lane, (target - current.get(lane)) / (SampleType)gainInterval);
+		}
+	}
+};
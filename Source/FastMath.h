@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Created: 17 Oct 2026 2:36:10pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Branch-free tanh and sin for the saturation curves. Every function is a
+// template on the lane type, so the same code runs on juce::dsp::SIMDRegister
+// and on the ScalarLanes fallback. Only +, -, *, min, max and one divide are
+// used.
+//
+// Double lanes work too, with the same coefficients, so they are as accurate
+// as the float versions. That is ample for a saturation curve.
+namespace FastMath {
+
+// Lane-wise a / b. SIMDRegister has no divide, so use the native one when there is one.
+template <typename Lanes>
+inline Lanes divide(Lanes a, const Lanes& b) noexcept
+{
+	for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane)
+		a.set(lane, a.get(lane) / b.get(lane));
+
+	return a;
+}
+
+#if JUCE_USE_SIMD && JUCE_USE_SSE_INTRINSICS && defined(__AVX2__)
+inline juce::dsp::SIMDRegister<float> divide(juce::dsp::SIMDRegister<float> a, const juce::dsp::SIMDRegister<float>& b) noexcept
+{
+	a.value = _mm256_div_ps(a.value, b.value);
+	return a;
+}
+
+inline juce::dsp::SIMDRegister<double> divide(
+	juce::dsp::SIMDRegister<double> a, const juce::dsp::SIMDRegister<double>& b) noexcept
+{
+	a.value = _mm256_div_pd(a.value, b.value);
+	return a;
+}
+#elif JUCE_USE_SIMD && JUCE_USE_SSE_INTRINSICS
+inline juce::dsp::SIMDRegister<float> divide(juce::dsp::SIMDRegister<float> a, const juce::dsp::SIMDRegister<float>& b) noexcept
+{
+	a.value = _mm_div_ps(a.value, b.value);
+	return a;
+}
+
+inline juce::dsp::SIMDRegister<double> divide(
+	juce::dsp::SIMDRegister<double> a, const juce::dsp::SIMDRegister<double>& b) noexcept
+{
+	a.value = _mm_div_pd(a.value, b.value);
+	return a;
+}
+#elif JUCE_USE_SIMD && JUCE_USE_ARM_NEON && defined(__aarch64__)
+inline juce::dsp::SIMDRegister<float> divide(juce::dsp::SIMDRegister<float> a, const juce::dsp::SIMDRegister<float>& b) noexcept
+{
+	a.value = vdivq_f32(a.value, b.value);
+	return a;
+}
+
+inline juce::dsp::SIMDRegister<double> divide(
+	juce::dsp::SIMDRegister<double> a, const juce::dsp::SIMDRegister<double>& b) noexcept
+{
+	a.value = vdivq_f64(a.value, b.value);
+	return a;
+}
+#endif
+
+template <typename Lanes>
+inline Lanes abs(const Lanes& x) noexcept
+{
+	return Lanes::max(x, Lanes::expand(0.0f) - x);
+}
+
+// tanh(x) as a 13/6 rational function on |x| <= 7.9, the point past which
+// tanh rounds to +-1 in float. Max absolute error against std::tanh is
+// below 5e-7 over the whole float range.
+template <typename Lanes>
+inline Lanes tanh(Lanes x) noexcept
+{
+	const auto limit = Lanes::expand(7.90531110763549805f);
+	x = Lanes::min(Lanes::max(x, Lanes::expand(0.0f) - limit), limit);
+
+	auto x2 = x * x;
+
+	auto p = Lanes::expand(-2.76076847742355e-16f);
+	p = p * x2 + Lanes::expand(2.00018790482477e-13f);
+	p = p * x2 + Lanes::expand(-8.60467152213735e-11f);
+	p = p * x2 + Lanes::expand(5.12229709037114e-08f);
+	p = p * x2 + Lanes::expand(1.48572235717979e-05f);
+	p = p * x2 + Lanes::expand(6.37261928875436e-04f);
+	p = p * x2 + Lanes::expand(4.89352455891786e-03f);
+	p = p * x;
+
+	auto q = Lanes::expand(1.19825839466702e-06f);
+	q = q * x2 + Lanes::expand(1.18534705686654e-04f);
+	q = q * x2 + Lanes::expand(2.26843463243900e-03f);
+	q = q * x2 + Lanes::expand(4.89352518554385e-03f);
+
+	return divide(p, q);
+}
+
+// sin(x) for |x| < 2^22. The argument is brought into [-pi, pi] with a
+// two-part 2 pi, folded into [-pi/2, pi/2] with sin(x) = sin(+-pi - x) and
+// evaluated as a degree 11 odd polynomial. Max absolute error is below
+// 5e-7 for |x| < 1000, growing with |x| as the reduction loses bits.
+template <typename Lanes>
+inline Lanes sin(Lanes x) noexcept
+{
+	// Adding and removing 1.5 * 2^23, or 2^52 for double, rounds to the nearest integer
+	using Element = typename Lanes::ElementType;
+	const auto magic = Lanes::expand(std::is_same_v<Element, float> ? (Element)12582912.0 : (Element)6755399441055744.0);
+	auto k = (x * Lanes::expand(0.159154943091895336f) + magic) - magic;
+
+	x = x - k * Lanes::expand(6.28125f);
+	x = x - k * Lanes::expand(1.93530717958647692e-3f);
+
+	const auto pi = Lanes::expand(juce::MathConstants<float>::pi);
+	auto folded = Lanes::min(x, pi - x);
+	x = Lanes::max(folded, Lanes::expand(0.0f) - pi - folded);
+
+	auto x2 = x * x;
+
+	auto p = Lanes::expand(-2.50521083854417188e-8f);
+	p = p * x2 + Lanes::expand(2.75573192239858907e-6f);
+	p = p * x2 + Lanes::expand(-1.98412698412698413e-4f);
+	p = p * x2 + Lanes::expand(8.33333333333333333e-3f);
+	p = p * x2 + Lanes::expand(-1.66666666666666667e-1f);
+
+	return x + x * x2 * p;
+}
+
+} // namespace FastMath
@@ -12,148 +12,173 @@
 
 #include <JuceHeader.h>
 
-#include "ProcessorBase.h"
-
-class HighPassProcessor : public ProcessorBase {
+#include "BiquadDesign.h"
+#include "SvfFilter.h"
+
+// Common part of the five EQ bands. A band only designs coefficients, the
+// filtering itself is done for all bands at once by BiquadCascade, or by
+// SvfCascade when the band is in SVF mode.
+//
+// The design is kept in double for the cascades and copied into a
+// Coefficients object, created once with room for a biquad, for drawing. So
+// updateSettings() is safe to call from the audio thread. In SVF mode the
+// Coefficients hold the equivalent biquad.
+class FilterBand {
 public:
-	HighPassProcessor() { }
+	FilterBand() { jassert(coeffs->coefficients.size() == BiquadDesign::numCoeffs); }
+	virtual ~FilterBand() { }
+
+	juce::dsp::IIR::Coefficients<float>* getCoeffs() { return coeffs.get(); }
+	// The biquad design, or in SVF mode the equivalent biquad
+	const double* getDesign() const noexcept { return design; }
+	const SvfParameters& getSvfParameters() const noexcept { return svfParams; }
 
-	const juce::String getName() const override { return "HighPassFilter"; }
+	// Takes effect at the next updateSettings()
+	void setSvfMode(bool shouldUseSvf) noexcept { svfMode = shouldUseSvf; }
+	bool isSvfMode() const noexcept { return svfMode; }
 
-	void prepareToPlay(double sampleRate, int samplesPerBlock) override
+	// True when the band leaves the signal as it is, so ChannelStrip can skip it
+	bool isFlat() const noexcept { return flat; }
+
+	// True once after each redesign, so the cascade only copies bands that moved
+	bool takeChanged() noexcept
 	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 200.0f);
+		auto wasChanged = changed;
+		changed = false;
+		return wasChanged;
+	}
 
-		juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 };
-		filter.prepare(spec);
+protected:
+	// Storage for a redesign, also flags the band as changed. Call show() after.
+	double* raw() noexcept
+	{
+		changed = true;
+		return design;
 	}
 
-	void updateSettings(int sampleRate, float freq)
+	// Storage for an SVF redesign, also flags the band as changed
+	SvfParameters& svf() noexcept
 	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, freq);
+		changed = true;
+		return svfParams;
 	}
 
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
+	// Refreshes the displayed coefficients and the flat flag after a redesign
+	void show() noexcept
 	{
-		juce::dsp::AudioBlock<float> block(buffer);
-		juce::dsp::ProcessContextReplacing<float> context(block);
-		filter.process(context);
+		std::copy(design, design + BiquadDesign::numCoeffs, coeffs->getRawCoefficients());
+		flat = BiquadDesign::isIdentity(design);
 	}
 
-	void reset() override { filter.reset(); }
+	// For bands that count as flat at some setting other than unity
+	void setFlat(bool shouldBeFlat) noexcept { flat = shouldBeFlat; }
 
-	juce::dsp::IIR::Coefficients<float>* getCoeffs() { return filter.state.get(); }
+	// The same after an SVF redesign, via the equivalent biquad
+	void showSvf() noexcept
+	{
+		SvfDesign::toBiquad(svfParams, design);
+		show();
+	}
 
 private:
-	juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> filter;
+	juce::dsp::IIR::Coefficients<float>::Ptr coeffs { new juce::dsp::IIR::Coefficients<float>(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f) };
+	double design[BiquadDesign::numCoeffs] { 1.0, 0.0, 0.0, 0.0, 0.0 };
+	SvfParameters svfParams;
+	bool changed = true;
+	bool flat = true;
+	bool svfMode = false;
 };
 
 
 //===================================================================
-class LowShelfProcessor : public ProcessorBase {
+class HighPassProcessor : public FilterBand {
 public:
-	LowShelfProcessor() { }
-
-	const juce::String getName() const override { return "LowShelfFilter"; }
-
-	void prepareToPlay(double sampleRate, int samplesPerBlock) override
-	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(sampleRate, 200.0f, 0.7f, 0.0f);
+	HighPassProcessor() { }
 
-		juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 };
-		filter.prepare(spec);
-	}
+	// The lowest setting counts as off
+	static constexpr float minFrequency = 20.0f;
 
-	void updateSettings(int sampleRate, float freq, float q, float gain)
-	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(sampleRate, freq, q, gain);
-	}
+	void prepare(double sampleRate) { updateSettings(sampleRate, 200.0f); }
 
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
+	void updateSettings(double sampleRate, float freq)
 	{
-		juce::dsp::AudioBlock<float> block(buffer);
-		juce::dsp::ProcessContextReplacing<float> context(block);
-
-		filter.process(context);
+		if (isSvfMode()) {
+			SvfDesign::makeHighPass(svf(), sampleRate, freq);
+			showSvf();
+		} else {
+			BiquadDesign::makeHighPass(raw(), sampleRate, freq);
+			show();
+		}
+
+		setFlat(freq <= minFrequency);
 	}
+};
 
-	void reset() override { filter.reset(); }
 
-	juce::dsp::IIR::Coefficients<float>* getCoeffs() { return filter.state.get(); }
+//===================================================================
+class LowShelfProcessor : public FilterBand {
+public:
+	LowShelfProcessor() { }
 
+	void prepare(double sampleRate) { updateSettings(sampleRate, 200.0f, 0.7f, 0.0f); }
 
-private:
-	juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> filter;
+	void updateSettings(double sampleRate, float freq, float q, float gain)
+	{
+		if (isSvfMode()) {
+			SvfDesign::makeLowShelf(svf(), sampleRate, freq, q, gain);
+			showSvf();
+		} else {
+			BiquadDesign::makeLowShelf(raw(), sampleRate, freq, q, gain);
+			show();
+		}
+	}
 };
 
 //===================================================================
-class HighShelfProcessor : public ProcessorBase {
+class HighShelfProcessor : public FilterBand {
 public:
 	HighShelfProcessor() { }
 
-	const juce::String getName() const override { return "HighShelfFilter"; }
-
-	void prepareToPlay(double sampleRate, int samplesPerBlock) override
-	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 2000.0f, 0.7f, 1.0f);
-
-		juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 };
-		filter.prepare(spec);
-	}
+	void prepare(double sampleRate) { updateSettings(sampleRate, 2000.0f, 0.7f, 1.0f); }
 
-	void updateSettings(int sampleRate, float freq, float q, float gain)
+	void updateSettings(double sampleRate, float freq, float q, float gain)
 	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, freq, q, gain);
+		if (isSvfMode()) {
+			SvfDesign::makeHighShelf(svf(), sampleRate, freq, q, gain);
+			showSvf();
+		} else {
+			BiquadDesign::makeHighShelf(raw(), sampleRate, freq, q, gain);
+			show();
+		}
 	}
-
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
-	{
-		juce::dsp::AudioBlock<float> block(buffer);
-		juce::dsp::ProcessContextReplacing<float> context(block);
-
-		filter.process(context);
-	}
-
-	void reset() override { filter.reset(); }
-
-	juce::dsp::IIR::Coefficients<float>* getCoeffs() { return filter.state.get(); }
-
-private:
-	juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> filter;
 };
 
 //===================================================================
-class PeakProcessor : public ProcessorBase {
+class PeakProcessor : public FilterBand {
 public:
 	PeakProcessor() { }
 
-	const juce::String getName() const override { return "PeakFilter"; }
-
-	void prepareToPlay(double sampleRate, int samplesPerBlock) override
-	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 2000.0f, 0.7f, 1.0f);
+	void prepare(double sampleRate) { updateSettings(sampleRate, 2000.0f, 0.7f, 1.0f); }
 
-		juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 };
-		filter.prepare(spec);
-	}
+	// A dynamic peak runs from the SVF design whatever the backend, see
+	// DynamicPeak. Takes effect at the next updateSettings().
+	void setDynamic(bool shouldBeDynamic) noexcept { dynamic = shouldBeDynamic; }
+	bool isDynamic() const noexcept { return dynamic; }
 
-	void updateSettings(int sampleRate, float freq, float q, float gain)
+	void updateSettings(double sampleRate, float freq, float q, float gain)
 	{
-		*filter.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, freq, q, gain);
+		if (isSvfMode()) {
+			SvfDesign::makePeakFilter(svf(), sampleRate, freq, q, gain);
+			showSvf();
+		} else {
+			BiquadDesign::makePeakFilter(raw(), sampleRate, freq, q, gain);
+			show();
+
+			if (dynamic)
+				SvfDesign::makePeakFilter(svf(), sampleRate, freq, q, gain);
+		}
 	}
 
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
-	{
-		juce::dsp::AudioBlock<float> block(buffer);
-		juce::dsp::ProcessContextReplacing<float> context(block);
-
-		filter.process(context);
-	}
-
-	void reset() override { filter.reset(); }
-
-	juce::dsp::IIR::Coefficients<float>* getCoeffs() { return filter.state.get(); }
-
 private:
-	juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> filter;
+	bool dynamic = false;
 };
\ No newline at end of file
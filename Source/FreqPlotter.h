@@ -12,19 +12,59 @@
 
 #include <JuceHeader.h>
 
+#include "BiquadResponse.h"
+
 //==============================================================================
-/*
-*/
-class FreqPlotter : public juce::Component {
+// The background thread that renders the EQ curves, one per process and
+// shared by every open editor through juce::SharedResourcePointer.
+struct PlotRenderThread : public juce::TimeSliceThread {
+	PlotRenderThread()
+		: juce::TimeSliceThread("j13 plot")
+	{
+		startThread();
+	}
+
+	~PlotRenderThread() override { stopThread(1000); }
+};
+
+//==============================================================================
+// The EQ plot. paint() only blits: the curves are evaluated and drawn on
+// PlotRenderThread from a copy of the layout and coefficients that paint()
+// posts whenever they change, and the finished image comes back through a
+// double buffer.
+class FreqPlotter : public juce::Component, private juce::TimeSliceClient, private juce::AsyncUpdater {
 public:
-	FreqPlotter() { setfrequencyRange(20.0f, 20000.0f); }
+	FreqPlotter()
+	{
+		// paint() always covers the whole plot with an RGB image
+		setOpaque(true);
+		setfrequencyRange(20.0f, 20000.0f);
+		renderThread->addTimeSliceClient(this);
+	}
 
-	~FreqPlotter() override { }
+	// Waits for a render in progress
+	~FreqPlotter() override
+	{
+		renderThread->removeTimeSliceClient(this);
+		cancelPendingUpdate();
+	}
 
 	void paint(juce::Graphics& g) override
 	{
-		renderGraph(g);
-		return;
+		requestRender();
+
+		juce::Image image;
+
+		{
+			const juce::SpinLock::ScopedLockType lock(renderLock);
+			image = front;
+		}
+
+		// Until the curves at this size are ready
+		if (image.getWidth() != getWidth() || image.getHeight() != getHeight())
+			image = backgroundImage;
+
+		g.drawImageAt(image, 0, 0, false);
 	}
 
 	void resized() override
@@ -37,13 +77,11 @@ public:
 		auto width = area.getWidth();
 		auto height = area.getHeight();
 
-		canvas = juce::Image(juce::Image::PixelFormat::RGB, width, height, true);
-		juce::Graphics g(canvas);
+		// Software, as the render thread draws it too
+		backgroundImage = juce::Image(juce::Image::PixelFormat::RGB, width, height, true, juce::SoftwareImageType());
+		juce::Graphics g(backgroundImage);
 
-		backgroundImage = juce::Image(juce::Image::PixelFormat::RGB, width, height, true);
-		juce::Graphics gg(backgroundImage);
-
-		drawBackground(gg);
+		drawBackground(g);
 	}
 
 	void setSampleRate(float rate) { sampleRate = rate; }
@@ -60,24 +98,8 @@ public:
 	juce::Colour curveColours[6] = { juce::Colours::darkred, juce::Colours::darkgreen, juce::Colours::darkcyan,
 		juce::Colours::darkmagenta, juce::Colours::darkorange, juce::Colours::darkturquoise };
 
-	void renderGraph(juce::Graphics& g)
-	{
-		g.drawImageAt(backgroundImage, 0, 0, false);
-
-		auto n = curveCoeffs.size();
-
-		//setPlotColour(juce::Colours::darkred);
-		drawCompositeCurve(g);
-
-		for (int i = 0; i < n; ++i) {
-			setPlotColour(curveColours[i]);
-			drawCurve(g, i);
-		}
-	}
-
 private:
 	juce::Image backgroundImage;
-	juce::Image canvas;
 
 	juce::Rectangle<float> graphArea { 0.0f, 0.0f, 0.0f, 0.0f };
 	juce::Rectangle<float> frequencyLabelArea { 0.0f, 0.0f, 0.0f, 0.0f };
@@ -124,62 +146,273 @@ private:
 
 	juce::Array<juce::dsp::IIR::Coefficients<float>::Ptr> curveCoeffs;
 
-	float gainToGraphY(float gain)
+	// Where the graph is and what it spans, the part of the state a render needs
+	struct Layout {
+		int width = 0;
+		int height = 0;
+
+		float graphX = 0.0f;
+		float graphY = 0.0f;
+		float graphHeight = 0.0f;
+		float graphWidth = 0.0f;
+
+		float maxGain = 10.0f;
+		float minGain = 0.1f;
+
+		float minFrequency = 20.0f;
+		float maxFrequency = 20000.0f;
+
+		float sampleRate = 48000.0f;
+
+		bool operator==(const Layout&) const = default;
+
+		float gainToGraphY(float gain) const
+		{
+			if (gain > maxGain)
+				gain = maxGain;
+
+			if (gain < minGain)
+				gain = minGain;
+
+			auto maxDecibels = juce::Decibels::gainToDecibels(maxGain);
+			auto minDecibels = juce::Decibels::gainToDecibels(minGain);
+			auto decibels = juce::Decibels::gainToDecibels(gain);
+
+			auto decibelRange = maxDecibels - minDecibels;
+			auto yRange = graphHeight;
+
+			auto py = ((maxDecibels - decibels) / decibelRange) * yRange;
+
+			return py;
+		}
+
+		float frequencyToGraphX(float frequency) const
+		{
+			// auto logMin = log10(minFrequency / minFrequency); //  ==>> graphX
+			auto logMax = log10(maxFrequency / minFrequency); //  ==>> graphX + graphWidth
+			// auto logFreq = log10(frequency / minFrequency);
+
+			auto xMin = graphX;
+			auto xMax = graphX + graphWidth;
+
+			auto xScaleFactor = (xMax - xMin) / logMax;
+			auto px = graphX + (xScaleFactor * log10(frequency / minFrequency));
+
+			return px;
+		}
+
+		juce::Point<float> getGraphPoint(float frequency, float gain) const
+		{
+			auto px = frequencyToGraphX(frequency);
+			auto py = gainToGraphY(gain);
+
+			return (juce::Point<float>(px, py));
+		}
+
+		float getGraphFreq(float x) const
+		{
+			auto logMax = log10(maxFrequency / minFrequency);
+
+			auto xMin = graphX;
+			auto xMax = graphX + graphWidth;
+
+			auto xScaleFactor = (xMax - xMin) / logMax;
+
+			auto u = (x - graphX) / xScaleFactor;
+			float frequency = pow(10.0, u) * minFrequency;
+
+			return frequency;
+		}
+	};
+
+	Layout getLayout() const
+	{
+		return { getWidth(), getHeight(), graphX, graphY, graphHeight, graphWidth, maxGain, minGain, minFrequency,
+			maxFrequency, sampleRate };
+	}
+
+	float gainToGraphY(float gain) const { return getLayout().gainToGraphY(gain); }
+	float frequencyToGraphX(float frequency) const { return getLayout().frequencyToGraphX(frequency); }
+	juce::Point<float> getGraphPoint(float frequency, float gain) const { return getLayout().getGraphPoint(frequency, gain); }
+	float getGraphFreq(float x) const { return getLayout().getGraphFreq(x); }
+
+	//==========================================================================
+	// Everything a render needs, copied, so the render thread shares nothing
+	// with the component but the images
+	using Biquad = std::array<float, BiquadResponse::numCoeffs>;
+
+	struct RenderRequest {
+		Layout layout;
+		juce::Image background;
+		std::vector<Biquad> curves;
+	};
+
+	juce::SharedResourcePointer<PlotRenderThread> renderThread;
+
+	RenderRequest lastRequest;
+
+	// The curves of the current paint, refilled in place
+	std::vector<Biquad> paintedCurves;
+
+	juce::SpinLock renderLock;
+	RenderRequest pending;
+	bool hasRequest = false;
+	juce::Image front;
+
+	// Used by the render thread only. The frequency of every pixel column of
+	// the graph, and each curve's magnitude there. A curve is only evaluated
+	// again when its coefficients change, and the composite only when one of
+	// the curves does.
+	struct CurveMagnitudes {
+		Biquad coefficients {};
+		std::vector<float> magnitudes;
+	};
+
+	Layout renderedLayout;
+	juce::Image back;
+	std::vector<float> columnFrequencies;
+	BiquadResponse columnResponse;
+	std::vector<CurveMagnitudes> curveMagnitudes;
+	std::vector<float> compositeMagnitudes;
+
+	// IIR::Coefficients as a biquad; first order sets are padded, higher orders left flat
+	static Biquad toBiquad(const juce::dsp::IIR::Coefficients<float>& z)
+	{
+		auto* c = z.coefficients.begin();
+
+		switch (z.coefficients.size()) {
+		case 5:
+			return { c[0], c[1], c[2], c[3], c[4] };
+		case 3:
+			return { c[0], c[1], 0.0f, c[2], 0.0f };
+		default:
+			return { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		}
+	}
+
+	// Posts the current state to the render thread if it differs from the last one posted
+	void requestRender()
 	{
-		if (gain > maxGain)
-			gain = maxGain;
+		auto layout = getLayout();
 
-		if (gain < minGain)
-			gain = minGain;
+		paintedCurves.clear();
 
-		auto maxDecibels = juce::Decibels::gainToDecibels(maxGain);
-		auto minDecibels = juce::Decibels::gainToDecibels(minGain);
-		auto decibels = juce::Decibels::gainToDecibels(gain);
+		for (auto& z : curveCoeffs)
+			paintedCurves.push_back(toBiquad(*z));
 
-		auto decibelRange = maxDecibels - minDecibels;
-		auto yRange = graphHeight;
+		if (layout == lastRequest.layout && backgroundImage == lastRequest.background && paintedCurves == lastRequest.curves)
+			return;
+
+		lastRequest.layout = layout;
+		lastRequest.background = backgroundImage;
+		lastRequest.curves = paintedCurves;
 
-		auto py = ((maxDecibels - decibels) / decibelRange) * yRange;
+		auto request = lastRequest;
 
-		return py;
+		const juce::SpinLock::ScopedLockType lock(renderLock);
+		pending = std::move(request);
+		hasRequest = true;
 	}
 
-	float frequencyToGraphX(float frequency)
+	int useTimeSlice() override
 	{
-		// auto logMin = log10(minFrequency / minFrequency); //  ==>> graphX
-		auto logMax = log10(maxFrequency / minFrequency); //  ==>> graphX + graphWidth
-		// auto logFreq = log10(frequency / minFrequency);
+		RenderRequest request;
+
+		{
+			const juce::SpinLock::ScopedLockType lock(renderLock);
+
+			if (!hasRequest)
+				return 20;
+
+			request = std::move(pending);
+			hasRequest = false;
+
+			// A buffer paint() may still be drawing from is left to it
+			if (back.getWidth() != request.layout.width || back.getHeight() != request.layout.height
+				|| back.getReferenceCount() > 1)
+				back = juce::Image();
+		}
+
+		if (request.layout.width <= 0 || request.layout.height <= 0)
+			return 20;
+
+		if (!back.isValid()) {
+			back = juce::Image(
+				juce::Image::PixelFormat::RGB, request.layout.width, request.layout.height, false, juce::SoftwareImageType());
+		}
 
-		auto xMin = graphX;
-		auto xMax = graphX + graphWidth;
+		renderGraph(request);
 
-		auto xScaleFactor = (xMax - xMin) / logMax;
-		auto px = graphX + (xScaleFactor * log10(frequency / minFrequency));
+		{
+			const juce::SpinLock::ScopedLockType lock(renderLock);
+			std::swap(front, back);
+		}
 
-		return px;
+		triggerAsyncUpdate();
+		return 0;
 	}
 
-	juce::Point<float> getGraphPoint(float frequency, float gain)
+	void handleAsyncUpdate() override { repaint(); }
+
+	void renderGraph(const RenderRequest& request)
 	{
-		auto px = frequencyToGraphX(frequency);
-		auto py = gainToGraphY(gain);
+		updateMagnitudes(request);
 
-		return (juce::Point<float>(px, py));
+		juce::Graphics g(back);
+		g.drawImageAt(request.background, 0, 0, false);
+
+		auto n = request.curves.size();
+
+		drawCompositeCurve(g, request.layout, n);
+
+		for (size_t i = 0; i < n; ++i)
+			drawCurve(g, request.layout, i, curveColours[i % 6]);
 	}
 
-	float getGraphFreq(float x)
+	void updateMagnitudes(const RenderRequest& request)
 	{
-		auto logMax = log10(maxFrequency / minFrequency);
+		auto& layout = request.layout;
+
+		if (layout != renderedLayout || columnFrequencies.empty()) {
+			renderedLayout = layout;
+			columnFrequencies.clear();
+			curveMagnitudes.clear();
+
+			auto minX = layout.frequencyToGraphX(layout.minFrequency);
+			auto maxX = layout.frequencyToGraphX(layout.maxFrequency);
+
+			for (auto x = minX; x <= maxX; ++x)
+				columnFrequencies.push_back(layout.getGraphFreq(x));
 
-		auto xMin = graphX;
-		auto xMax = graphX + graphWidth;
+			columnResponse.setFrequencies(columnFrequencies.data(), (int)columnFrequencies.size(), layout.sampleRate);
+		}
+
+		auto numCurves = request.curves.size();
+		auto changed = curveMagnitudes.size() != numCurves;
+		curveMagnitudes.resize(numCurves);
+
+		for (size_t curveNum = 0; curveNum < numCurves; ++curveNum) {
+			auto& curve = curveMagnitudes[curveNum];
 
-		auto xScaleFactor = (xMax - xMin) / logMax;
+			if (curve.magnitudes.size() == columnFrequencies.size() && curve.coefficients == request.curves[curveNum])
+				continue;
 
-		auto u = (x - graphX) / xScaleFactor;
-		float frequency = pow(10.0, u) * minFrequency;
+			curve.coefficients = request.curves[curveNum];
+			curve.magnitudes.resize(columnFrequencies.size());
+			columnResponse.process(curve.coefficients.data(), curve.magnitudes.data());
 
-		return frequency;
+			changed = true;
+		}
+
+		if (!changed && compositeMagnitudes.size() == columnFrequencies.size())
+			return;
+
+		// normalize magnitude by subtracting one here to prevent the curve shifting
+		compositeMagnitudes.assign(columnFrequencies.size(), 0.0f);
+
+		for (auto& curve : curveMagnitudes)
+			for (size_t column = 0; column < columnFrequencies.size(); ++column)
+				compositeMagnitudes[column] += curve.magnitudes[column] - 1.0f;
 	}
 
 	juce::String getFreqString(float frequency)
@@ -321,36 +554,32 @@ private:
 		drawDecibelAxis(g, 15.0f, dashLengths, 2);
 	}
 
-	void drawCurve(juce::Graphics& g, int curveNum)
+	// On the render thread, from its cached magnitudes
+	void drawCurve(juce::Graphics& g, const Layout& layout, size_t curveNum, juce::Colour colour)
 	{
 		auto lastX = -1.0f;
 		auto lastY = -1.0f;
 
-		g.setColour(plotColour.withAlpha(0.7f));
-
-		auto z = curveCoeffs[curveNum].get();
+		g.setColour(colour.withAlpha(0.7f));
 
-		auto minX = frequencyToGraphX(minFrequency);
-		auto maxX = frequencyToGraphX(maxFrequency);
+		auto& magnitudes = curveMagnitudes[curveNum].magnitudes;
 
-		for (auto x = minX; x <= maxX; ++x) {
-			auto freq = getGraphFreq(x);
-
-			auto magnitude = z->getMagnitudeForFrequency(freq, sampleRate);
-			auto p = getGraphPoint(freq, magnitude);
+		for (size_t column = 0; column < columnFrequencies.size(); ++column) {
+			auto magnitude = magnitudes[column];
+			auto p = layout.getGraphPoint(columnFrequencies[column], magnitude);
 
 			if (lastX != -1.0f) {
 				g.drawLine(lastX, lastY, p.getX(), p.getY(), 2.0f);
 
-				auto height = p.getY() - (graphHeight / 2);
-				auto y = graphY + (graphHeight / 2);
+				auto height = p.getY() - (layout.graphHeight / 2);
+				auto y = layout.graphY + (layout.graphHeight / 2);
 
 				if (magnitude > 1.0f) {
 					height *= -1.0f;
 					y = y - height;
 				}
 
-				g.setColour(plotColour.withAlpha(0.1f));
+				g.setColour(colour.withAlpha(0.1f));
 				juce::Rectangle<int> fillArea(p.getX(), y, 1, height);
 				g.fillRect(fillArea);
 			}
@@ -360,43 +589,25 @@ private:
 		}
 	}
 
-	void drawCompositeCurve(juce::Graphics& g)
+	void drawCompositeCurve(juce::Graphics& g, const Layout& layout, size_t numCurves)
 	{
 		auto lastX = -1.0f;
 		auto lastY = -1.0f;
 
-		auto numCurves = curveCoeffs.size();
-		float magnitude;
-
 		if (numCurves < 1) {
 			return;
 		}
 
-		auto z = curveCoeffs[0].get();
-
-		auto minX = frequencyToGraphX(minFrequency);
-		auto maxX = frequencyToGraphX(maxFrequency);
-
-		g.setColour(plotColour);
-
-		for (auto x = minX; x <= maxX; ++x) {
-			auto freq = getGraphFreq(x);
-
-			magnitude = 0.0f;
-			// normalize magnitude by subtracting one here to prevent the curve shifting
-			for (auto curveNum = 0; curveNum < numCurves; ++curveNum) {
-				z = curveCoeffs[curveNum].get();
-				magnitude += z->getMagnitudeForFrequency(freq, sampleRate) - 1.0f;
-			}
-
-			auto p = getGraphPoint(freq, magnitude + 1.0f); // add the one back in here
+		for (size_t column = 0; column < columnFrequencies.size(); ++column) {
+			auto magnitude = compositeMagnitudes[column];
+			auto p = layout.getGraphPoint(columnFrequencies[column], magnitude + 1.0f); // add the one back in here
 
 			if (lastX != -1.0f) {
 				g.setColour(juce::Colours::blue);
 				g.drawLine(lastX, lastY, p.getX(), p.getY(), 2.0f);
 
-				auto height = p.getY() - (graphHeight / 2);
-				auto y = graphY + (graphHeight / 2);
+				auto height = p.getY() - (layout.graphHeight / 2);
+				auto y = layout.graphY + (layout.graphHeight / 2);
 
 				if (magnitude > 0.0f) {
 					height *= -1.0f;
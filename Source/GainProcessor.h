@@ -10,30 +10,69 @@
 
 #pragma once
 
-#include "ProcessorBase.h"
 #include <JuceHeader.h>
 
-class GainProcessor : public ProcessorBase {
+// A gain stage of the ChannelStrip. The gain is ramped over a few
+// milliseconds and advanced once per sample frame, so every channel of the
+// frame sees the same value.
+//
+// The ramp is multiplicative, i.e. a straight line in dB. Two stages whose
+// dB targets always sum to the same value then keep that sum at every
+// sample, which is how ChannelStrip folds the drive offset into the output.
+class GainProcessor {
 public:
-	GainProcessor() { gain.setGainDecibels(-12.0f); }
+	GainProcessor() { updateGain(-12.0f); }
 
-	void prepareToPlay(double sampleRate, int samplesPerBlock) override
+	void prepare(double sampleRate)
 	{
-		juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 };
-		gain.prepare(spec);
+		gain.reset(sampleRate, 0.005);
+		reset();
 	}
 
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
+	void reset() { gain.setCurrentAndTargetValue(gain.getTargetValue()); }
+	void updateGain(float newGain) { gain.setTargetValue(juce::Decibels::decibelsToGain(newGain)); }
+
+	float getNextGain() noexcept { return gain.getNextValue(); }
+
+private:
+	juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> gain { 1.0f };
+};
+
+// The ramp of a GainProcessor played back a fixed number of frames late, for
+// a gain that comes after a delay of the signal, so it still lines up with
+// a ramp ahead of the delay. Starts out holding the first gain it is given.
+class GainDelay {
+public:
+	void prepare(int delayInSamples)
 	{
-		juce::dsp::AudioBlock<float> block(buffer);
-		juce::dsp::ProcessContextReplacing<float> context(block);
-		gain.process(context);
+		delay = juce::jmax(0, delayInSamples);
+		gains.assign((size_t)delay + 1, 1.0f);
+		position = 0;
+		primed = false;
+	}
+
+	void reset() { primed = false; }
+
+	float process(float gain) noexcept
+	{
+		if (!primed) {
+			std::fill(gains.begin(), gains.end(), gain);
+			primed = true;
+		}
+
+		gains[(size_t)position] = gain;
+		position = position == delay ? 0 : position + 1;
+
+		return gains[(size_t)position];
 	}
 
-	void reset() override { gain.reset(); }
-	const juce::String getName() const override { return "Gain"; }
-	void updateGain(float newGain) { gain.setGainDecibels(newGain); }
+	// Every lane group replays the same frames, see ChannelStrip
+	int getPosition() const noexcept { return position; }
+	void setPosition(int newPosition) noexcept { position = newPosition; }
 
 private:
-	juce::dsp::Gain<float> gain;
+	std::vector<float> gains { 1.0f };
+	int delay = 0;
+	int position = 0;
+	bool primed = false;
 };
@@ -0,0 +1,440 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEq.h
+    Created: 17 Oct 2026 6:41:18pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadDesign.h"
+
+//==============================================================================
+// The background thread that designs linear phase kernels, one per process
+// and shared by every instance through juce::SharedResourcePointer.
+struct LinearPhaseDesignThread : public juce::TimeSliceThread {
+	LinearPhaseDesignThread()
+		: juce::TimeSliceThread("j13 linear phase")
+	{
+		startThread();
+	}
+
+	~LinearPhaseDesignThread() override { stopThread(1000); }
+};
+
+//==============================================================================
+// A run of EQ bands as one linear phase FIR, run as uniformly partitioned
+// overlap-save convolution with juce::dsp::FFT.
+//
+// The kernel has the combined magnitude response of the band designs and no
+// phase of its own: the zero phase impulse is centred at kernelLength / 2 and
+// Hann windowed. It is built on LinearPhaseDesignThread and handed over
+// through three slots, so the audio thread never waits or allocates. A new
+// kernel is crossfaded in over one partition, computed against the same
+// input spectra as the old one.
+//
+// All channels run in step on one kernel, except that the second channel
+// can have a kernel of its own, for the side channel in mid/side mode.
+//
+// juce::dsp::FFT only works in float, so the convolution and the input
+// spectra per channel are float whichever the host precision: a double host
+// gets float resolution from this EQ.
+class LinearPhaseEq : private juce::TimeSliceClient {
+public:
+	static constexpr int maxBands = 5;
+	static constexpr int numPartitions = 32;
+	static constexpr int maxKernels = 2;
+
+	LinearPhaseEq() { }
+	~LinearPhaseEq() override { designThread->removeTimeSliceClient(this); }
+
+	// Allocates everything for numChannels at sampleRate. The kernel is long
+	// enough for a quarter second of response; until the first design lands
+	// it is a plain delay.
+	void prepare(double sampleRate, int numChannels)
+	{
+		designThread->removeTimeSliceClient(this);
+
+		kernelLength = juce::nextPowerOfTwo((int)(sampleRate * 0.25));
+		partitionSize = kernelLength / numPartitions;
+		numBins = partitionSize + 1;
+
+		designFft = std::make_unique<juce::dsp::FFT>(orderOf(kernelLength));
+		partitionFft = std::make_unique<juce::dsp::FFT>(orderOf(2 * partitionSize));
+		kernelFft = std::make_unique<juce::dsp::FFT>(orderOf(2 * partitionSize));
+
+		for (auto& slot : slots) {
+			slot.re.assign((size_t)(maxKernels * numPartitions * numBins), 0.0f);
+			slot.im.assign((size_t)(maxKernels * numPartitions * numBins), 0.0f);
+			slot.numKernels = 1;
+			slot.state = freeSlot;
+		}
+
+		channelStates.resize((size_t)numChannels);
+
+		for (auto& channel : channelStates) {
+			channel.re.assign((size_t)(numPartitions * numBins), 0.0f);
+			channel.im.assign((size_t)(numPartitions * numBins), 0.0f);
+			channel.input.assign((size_t)(2 * partitionSize), 0.0f);
+			channel.output.assign((size_t)partitionSize, 0.0f);
+		}
+
+		scratch.assign((size_t)(4 * partitionSize), 0.0f);
+		fadeScratch.assign((size_t)(4 * partitionSize), 0.0f);
+		accumulatorRe.assign((size_t)numBins, 0.0f);
+		accumulatorIm.assign((size_t)numBins, 0.0f);
+		impulse.assign((size_t)(2 * kernelLength), 0.0f);
+
+		// A unit impulse at the centre of the kernel
+		impulse[(size_t)(kernelLength / 2)] = 1.0f;
+		partition(slots[0], 0);
+		slots[0].state = slotInUse;
+		current = 0;
+
+		reset();
+
+		designThread->addTimeSliceClient(this);
+	}
+
+	void reset()
+	{
+		for (auto& channel : channelStates) {
+			std::fill(channel.re.begin(), channel.re.end(), 0.0f);
+			std::fill(channel.im.begin(), channel.im.end(), 0.0f);
+			std::fill(channel.input.begin(), channel.input.end(), 0.0f);
+			std::fill(channel.output.begin(), channel.output.end(), 0.0f);
+		}
+
+		position = 0;
+		newest = 0;
+	}
+
+	// Polls for design requests faster while the EQ is in use
+	void setActive(bool isActive) noexcept { active = isActive; }
+
+	// Asks for a kernel with the response of numBands band designs, each
+	// (b0, b1, b2, a1, a2), and if secondDesigns is given a second kernel for
+	// the second channel. Real-time safe; returns false when the designer is
+	// copying the previous request, so call again later.
+	bool requestDesign(
+		int numBands, const double* const* designs, const double* const* secondDesigns = nullptr) noexcept
+	{
+		jassert(numBands <= maxBands);
+		const juce::SpinLock::ScopedTryLockType lock(requestLock);
+
+		if (!lock.isLocked())
+			return false;
+
+		requestedKernels = secondDesigns != nullptr ? 2 : 1;
+		requestedBands = juce::jmin(numBands, maxBands);
+
+		for (int band = 0; band < requestedBands; ++band) {
+			std::copy(designs[band], designs[band] + BiquadDesign::numCoeffs, requested[0][band]);
+
+			if (secondDesigns != nullptr)
+				std::copy(secondDesigns[band], secondDesigns[band] + BiquadDesign::numCoeffs, requested[1][band]);
+		}
+
+		hasRequest = true;
+		return true;
+	}
+
+	// Delay of the kernel centre plus one partition of buffering
+	int getLatencyInSamples() const noexcept { return kernelLength / 2 + partitionSize; }
+	int getLengthInSamples() const noexcept { return kernelLength + partitionSize; }
+
+	template <typename SampleType>
+	void process(SampleType* const* data, int numChannels, int startSample, int numSamples) noexcept
+	{
+		numChannels = juce::jmin(numChannels, (int)channelStates.size());
+
+		for (int done = 0; done < numSamples;) {
+			auto length = juce::jmin(numSamples - done, partitionSize - position);
+
+			for (int channel = 0; channel < numChannels; ++channel) {
+				auto& state = channelStates[(size_t)channel];
+				auto* samples = data[channel] + startSample + done;
+				auto* input = state.input.data() + partitionSize + position;
+				auto* output = state.output.data() + position;
+
+				for (int i = 0; i < length; ++i) {
+					input[i] = (float)samples[i];
+					samples[i] = (SampleType)output[i];
+				}
+			}
+
+			position += length;
+			done += length;
+
+			if (position == partitionSize) {
+				runPartition(numChannels);
+				position = 0;
+			}
+		}
+	}
+
+private:
+	enum SlotState { freeSlot = 0, buildingSlot, readySlot, slotInUse };
+
+	// Each kernel as numPartitions spectra of numBins, split into real and imaginary parts
+	struct Slot {
+		std::vector<float> re, im;
+		int numKernels = 1;
+		std::atomic<int> state { freeSlot };
+	};
+
+	// A ring of input spectra, the latest at index newest, and the overlap-save buffers
+	struct ChannelState {
+		std::vector<float> re, im;
+		std::vector<float> input, output;
+	};
+
+	juce::SharedResourcePointer<LinearPhaseDesignThread> designThread;
+
+	int kernelLength = 0;
+	int partitionSize = 0;
+	int numBins = 0;
+
+	std::unique_ptr<juce::dsp::FFT> partitionFft;
+
+	Slot slots[3];
+	int current = 0;
+
+	std::vector<ChannelState> channelStates;
+	int position = 0;
+	int newest = 0;
+
+	std::vector<float> scratch, fadeScratch, accumulatorRe, accumulatorIm;
+
+	juce::SpinLock requestLock;
+	double requested[maxKernels][maxBands][BiquadDesign::numCoeffs] {};
+	int requestedKernels = 1;
+	int requestedBands = 0;
+	bool hasRequest = false;
+	std::atomic<bool> active { false };
+
+	// Used by the design thread only
+	std::unique_ptr<juce::dsp::FFT> designFft, kernelFft;
+	std::vector<float> impulse;
+	double designs[maxKernels][maxBands][BiquadDesign::numCoeffs] {};
+	int numDesigns = 1;
+	int numDesignBands = 0;
+
+	static int orderOf(int size) noexcept
+	{
+		auto order = 0;
+
+		while ((1 << order) < size)
+			++order;
+
+		return order;
+	}
+
+	//==========================================================================
+	void runPartition(int numChannels) noexcept
+	{
+		auto previous = current;
+
+		for (int slot = 0; slot < 3; ++slot) {
+			auto expected = (int)readySlot;
+
+			if (slot != current && slots[slot].state.compare_exchange_strong(expected, slotInUse)) {
+				current = slot;
+				break;
+			}
+		}
+
+		newest = (newest + numPartitions - 1) % numPartitions;
+
+		for (int channel = 0; channel < numChannels; ++channel) {
+			auto& state = channelStates[(size_t)channel];
+
+			// The newest input spectrum, from the last two partitions of input
+			std::copy(state.input.begin(), state.input.end(), scratch.begin());
+			partitionFft->performRealOnlyForwardTransform(scratch.data(), true);
+
+			auto* re = state.re.data() + newest * numBins;
+			auto* im = state.im.data() + newest * numBins;
+
+			for (int k = 0; k < numBins; ++k) {
+				re[k] = scratch[(size_t)(2 * k)];
+				im[k] = scratch[(size_t)(2 * k + 1)];
+			}
+
+			std::copy(state.input.begin() + partitionSize, state.input.end(), state.input.begin());
+
+			convolve(state, slots[current], channel, scratch.data());
+
+			if (previous != current) {
+				convolve(state, slots[previous], channel, fadeScratch.data());
+
+				for (int i = 0; i < partitionSize; ++i) {
+					auto fade = (float)(i + 1) / (float)partitionSize;
+					state.output[(size_t)i] = fadeScratch[(size_t)(partitionSize + i)]
+						+ fade * (scratch[(size_t)(partitionSize + i)] - fadeScratch[(size_t)(partitionSize + i)]);
+				}
+			} else {
+				std::copy(scratch.begin() + partitionSize, scratch.begin() + 2 * partitionSize, state.output.begin());
+			}
+		}
+
+		if (previous != current)
+			slots[previous].state = freeSlot;
+	}
+
+	// Sums the products of the input spectra with the partitions of the
+	// channel's kernel and transforms back, leaving the new output in the
+	// second half of result
+	void convolve(const ChannelState& state, const Slot& kernel, int channel, float* result) noexcept
+	{
+		auto kernelOffset = juce::jmin(channel, kernel.numKernels - 1) * numPartitions * numBins;
+		std::fill(accumulatorRe.begin(), accumulatorRe.end(), 0.0f);
+		std::fill(accumulatorIm.begin(), accumulatorIm.end(), 0.0f);
+
+		auto* sumRe = accumulatorRe.data();
+		auto* sumIm = accumulatorIm.data();
+
+		for (int p = 0; p < numPartitions; ++p) {
+			auto offset = ((newest + p) % numPartitions) * numBins;
+			auto* xRe = state.re.data() + offset;
+			auto* xIm = state.im.data() + offset;
+			auto* hRe = kernel.re.data() + kernelOffset + p * numBins;
+			auto* hIm = kernel.im.data() + kernelOffset + p * numBins;
+
+			for (int k = 0; k < numBins; ++k) {
+				sumRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+				sumIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+			}
+		}
+
+		// The full, conjugate symmetric spectrum for the inverse transform
+		auto fftSize = 2 * partitionSize;
+
+		for (int k = 0; k < numBins; ++k) {
+			result[2 * k] = sumRe[k];
+			result[2 * k + 1] = sumIm[k];
+		}
+
+		for (int k = numBins; k < fftSize; ++k) {
+			result[2 * k] = sumRe[fftSize - k];
+			result[2 * k + 1] = -sumIm[fftSize - k];
+		}
+
+		partitionFft->performRealOnlyInverseTransform(result);
+	}
+
+	//==========================================================================
+	int useTimeSlice() override
+	{
+		{
+			const juce::SpinLock::ScopedLockType lock(requestLock);
+
+			if (!hasRequest)
+				return active ? 10 : 50;
+
+			std::memcpy(designs, requested, sizeof(designs));
+			numDesigns = requestedKernels;
+			numDesignBands = requestedBands;
+			hasRequest = false;
+		}
+
+		// Replace a kernel the audio thread has not picked up yet, else take a free slot
+		Slot* slot = nullptr;
+
+		for (auto state : { readySlot, freeSlot }) {
+			for (auto& candidate : slots) {
+				auto expected = (int)state;
+
+				if (candidate.state.compare_exchange_strong(expected, buildingSlot)) {
+					slot = &candidate;
+					break;
+				}
+			}
+
+			if (slot != nullptr)
+				break;
+		}
+
+		if (slot == nullptr) {
+			const juce::SpinLock::ScopedLockType lock(requestLock);
+
+			if (!hasRequest) {
+				std::memcpy(requested, designs, sizeof(requested));
+				requestedKernels = numDesigns;
+				requestedBands = numDesignBands;
+				hasRequest = true;
+			}
+
+			return 1;
+		}
+
+		for (int kernel = 0; kernel < numDesigns; ++kernel) {
+			design(designs[kernel]);
+			partition(*slot, kernel);
+		}
+
+		slot->numKernels = numDesigns;
+		slot->state = readySlot;
+
+		return 0;
+	}
+
+	// The zero phase impulse of the combined magnitude of the designed bands,
+	// moved to the kernel centre and windowed, in impulse
+	void design(const double (&bands)[maxBands][BiquadDesign::numCoeffs])
+	{
+		auto half = kernelLength / 2;
+
+		for (int k = 0; k <= half; ++k) {
+			auto w = juce::MathConstants<double>::twoPi * k / kernelLength;
+			auto z1 = std::polar(1.0, -w), z2 = z1 * z1;
+			auto magnitude = 1.0;
+
+			for (int band = 0; band < numDesignBands; ++band) {
+				auto* d = bands[band];
+				magnitude *= std::abs((d[0] + d[1] * z1 + d[2] * z2) / (1.0 + d[3] * z1 + d[4] * z2));
+			}
+
+			impulse[(size_t)(2 * k)] = (float)magnitude;
+			impulse[(size_t)(2 * k + 1)] = 0.0f;
+		}
+
+		for (int k = half + 1; k < kernelLength; ++k) {
+			impulse[(size_t)(2 * k)] = impulse[(size_t)(2 * (kernelLength - k))];
+			impulse[(size_t)(2 * k + 1)] = 0.0f;
+		}
+
+		designFft->performRealOnlyInverseTransform(impulse.data());
+
+		// Swapping the halves puts time zero at the centre
+		std::rotate(impulse.begin(), impulse.begin() + half, impulse.begin() + kernelLength);
+
+		for (int n = 0; n < kernelLength; ++n)
+			impulse[(size_t)n] *= (float)(0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n / kernelLength));
+	}
+
+	// Splits impulse into partitions and stores their spectra as the given kernel of slot
+	void partition(Slot& slot, int kernel)
+	{
+		auto offset = (size_t)(kernel * numPartitions * numBins);
+		std::vector<float> buffer((size_t)(4 * partitionSize));
+
+		for (int p = 0; p < numPartitions; ++p) {
+			std::fill(buffer.begin(), buffer.end(), 0.0f);
+			std::copy(impulse.begin() + p * partitionSize, impulse.begin() + (p + 1) * partitionSize, buffer.begin());
+			kernelFft->performRealOnlyForwardTransform(buffer.data(), true);
+
+			for (int k = 0; k < numBins; ++k) {
+				slot.re[offset + (size_t)(p * numBins + k)] = buffer[(size_t)(2 * k)];
+				slot.im[offset + (size_t)(p * numBins + k)] = buffer[(size_t)(2 * k + 1)];
+			}
+		}
+	}
+
+	JUCE_DECLARE_NON_COPYABLE(LinearPhaseEq)
+};
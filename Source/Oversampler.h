@@ -0,0 +1,246 @@
+/*
+  ==============================================================================
+
+    Oversampler.h
+    Created: 17 Oct 2026 3:22:47pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+#include "Saturation.h"
+
+//==============================================================================
+// Coefficients for a half-band filter built from two parallel chains of
+// first order allpasses, as in Laurent de Soras' HIIR library. transition is
+// the width of the transition band as a fraction of the oversampled rate.
+struct HalfBandDesign {
+	static void compute(double* coefs, int numCoefs, double transition)
+	{
+		auto k = std::tan((1.0 - transition * 2.0) * juce::MathConstants<double>::pi / 4.0);
+		k *= k;
+
+		auto kksqrt = std::pow(1.0 - k * k, 0.25);
+		auto e = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+		auto e4 = e * e * e * e;
+		auto q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+		auto order = numCoefs * 2 + 1;
+
+		for (int i = 0; i < numCoefs; ++i) {
+			auto num = sumNumerator(q, order, i + 1) * std::pow(q, 0.25);
+			auto den = sumDenominator(q, order, i + 1) + 0.5;
+			auto ww = num / den;
+			auto wwsq = ww * ww;
+			auto x = std::sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+
+			coefs[i] = (1.0 - x) / (1.0 + x);
+		}
+	}
+
+private:
+	static double sumNumerator(double q, int order, int c)
+	{
+		double acc = 0.0, term;
+		int i = 0;
+
+		do {
+			term = std::pow(q, i * (i + 1)) * std::sin((i * 2 + 1) * c * juce::MathConstants<double>::pi / order);
+			acc += (i & 1) ? -term : term;
+			++i;
+		} while (std::abs(term) > 1.0e-100);
+
+		return acc;
+	}
+
+	static double sumDenominator(double q, int order, int c)
+	{
+		double acc = 0.0, term;
+		int i = 1;
+
+		do {
+			term = std::pow(q, i * i) * std::cos(i * 2 * c * juce::MathConstants<double>::pi / order);
+			acc += (i & 1) ? -term : term;
+			++i;
+		} while (std::abs(term) > 1.0e-100);
+
+		return acc;
+	}
+};
+
+//==============================================================================
+// Runs a SaturationProcessor at 2, 4 or 8 times the host rate, one sample
+// frame at a time so it fits in ChannelStrip's fused loop. Each 2x stage is
+// a polyphase IIR half-band, used once to interpolate and once to decimate.
+//
+// The first stage has to be steep, later ones only reject images far above
+// the audio band and get by with fewer allpasses. All give 80 dB or more.
+template <typename SampleType>
+class Oversampler {
+public:
+	static constexpr size_t numLanes = BiquadCascade<SampleType>::numLanes;
+
+	static constexpr int maxStages = 3;
+	static constexpr int maxCoefs = 6;
+
+	Oversampler()
+	{
+		for (int stage = 0; stage < maxStages; ++stage)
+			HalfBandDesign::compute(coefs[stage], stageSpecs[stage].numCoefs, stageSpecs[stage].transition);
+
+		reset();
+	}
+
+	// 0 runs the saturation at the host rate, each stage doubles the rate
+	void setNumStages(int newNumStages)
+	{
+		newNumStages = juce::jlimit(0, maxStages, newNumStages);
+
+		if (newNumStages != numStages) {
+			numStages = newNumStages;
+			reset();
+		}
+	}
+
+	int getNumStages() const noexcept { return numStages; }
+
+	// Delay of the interpolators and decimators at low frequencies, in host samples
+	double getLatencyInSamples() const
+	{
+		double latency = 0.0;
+
+		for (int stage = 0; stage < numStages; ++stage) {
+			// A section (c + z^-2) / (1 + c z^-2) delays DC by 2 (1 - c) / (1 + c).
+			// The one sample offset of the second path cancels out between the
+			// interpolator and the decimator.
+			double paths[2] = { 0.0, 0.0 };
+
+			for (int i = 0; i < stageSpecs[stage].numCoefs; ++i)
+				paths[i & 1] += 2.0 * (1.0 - coefs[stage][i]) / (1.0 + coefs[stage][i]);
+
+			// once up and once down, at 2^(stage + 1) times the host rate
+			latency += (paths[0] + paths[1]) / (double)(1 << (stage + 1));
+		}
+
+		return latency;
+	}
+
+	void reset()
+	{
+		for (auto& stage : state)
+			for (auto& direction : stage)
+				for (auto& section : direction)
+					for (auto& lanes : section)
+						std::fill(lanes, lanes + numLanes, SampleType());
+	}
+
+	//==========================================================================
+	// Register copy for the length of one segment, see BiquadCascade::Registers.
+	// Lanes narrower than the oversampler can start at any of its lanes.
+	template <typename Lanes>
+	class Registers {
+	public:
+		explicit Registers(const Oversampler& oversampler, size_t firstLane = 0)
+			: numStages(oversampler.numStages)
+			, lane(firstLane)
+		{
+			jassert(lane + Lanes::SIMDNumElements <= numLanes);
+
+			for (int stage = 0; stage < numStages; ++stage) {
+				numCoefs[stage] = stageSpecs[stage].numCoefs;
+
+				for (int i = 0; i < numCoefs[stage]; ++i) {
+					coefs[stage][i] = Lanes::expand((SampleType)oversampler.coefs[stage][i]);
+
+					for (int direction = 0; direction < 2; ++direction) {
+						x1[stage][direction][i] = Lanes::fromRawArray(oversampler.state[stage][direction][i][0] + lane);
+						y1[stage][direction][i] = Lanes::fromRawArray(oversampler.state[stage][direction][i][1] + lane);
+					}
+				}
+			}
+		}
+
+		void store(Oversampler& oversampler) const
+		{
+			for (int stage = 0; stage < numStages; ++stage)
+				for (int i = 0; i < numCoefs[stage]; ++i)
+					for (int direction = 0; direction < 2; ++direction) {
+						x1[stage][direction][i].copyToRawArray(oversampler.state[stage][direction][i][0] + lane);
+						y1[stage][direction][i].copyToRawArray(oversampler.state[stage][direction][i][1] + lane);
+					}
+		}
+
+		Lanes process(SaturationProcessor& saturation, Lanes x) noexcept
+		{
+			if (numStages == 0)
+				return saturation.process(x);
+
+			return processStage<0>(saturation, x);
+		}
+
+	private:
+		enum { up = 0, down = 1 };
+
+		int numStages;
+		size_t lane;
+		int numCoefs[maxStages] {};
+		Lanes coefs[maxStages][maxCoefs];
+		Lanes x1[maxStages][2][maxCoefs], y1[maxStages][2][maxCoefs];
+
+		// A template on the stage so the recursion unrolls at compile time
+		template <int stage>
+		Lanes processStage(SaturationProcessor& saturation, Lanes x) noexcept
+		{
+			auto first = x, second = x;
+			runPaths<stage>(up, first, second);
+
+			if (stage + 1 < numStages) {
+				if constexpr (stage + 1 < maxStages) {
+					first = processStage<stage + 1>(saturation, first);
+					second = processStage<stage + 1>(saturation, second);
+				}
+			} else {
+				first = saturation.process(first);
+				second = saturation.process(second);
+			}
+
+			// the decimator takes the later sample through the first path
+			runPaths<stage>(down, second, first);
+
+			return (first + second) * Lanes::expand((SampleType)0.5);
+		}
+
+		// Every other section belongs to the same path, y = c (x - y[-1]) + x[-1]
+		template <int stage>
+		void runPaths(int direction, Lanes& path0, Lanes& path1) noexcept
+		{
+			for (int i = 0; i < stageSpecs[stage].numCoefs; ++i) {
+				auto& x = (i & 1) ? path1 : path0;
+				auto& xPrev = x1[stage][direction][i];
+				auto& yPrev = y1[stage][direction][i];
+
+				auto y = coefs[stage][i] * (x - yPrev) + xPrev;
+				xPrev = x;
+				yPrev = y;
+				x = y;
+			}
+		}
+	};
+
+private:
+	struct StageSpec {
+		int numCoefs;
+		double transition;
+	};
+
+	static constexpr StageSpec stageSpecs[maxStages] = { { 6, 0.05 }, { 3, 0.25 }, { 2, 0.35 } };
+
+	int numStages = 0;
+	double coefs[maxStages][maxCoefs] {};
+	alignas(32) SampleType state[maxStages][2][maxCoefs][2][numLanes];
+};
@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Created: 17 Oct 2026 12:05:13pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// The raw parameter values used by updateGraph(), read once per block through
+// pointers that are looked up by ID only when the processor is built.
+//
+// update() compares the fresh values with the previous block and returns a
+// mask of the groups that moved, so idle bands can be skipped entirely.
+class ParameterSnapshot {
+public:
+	enum Param {
+		inGain,
+		drive,
+		inClean,
+		inWarm,
+		outGain,
+		outClean,
+		outWarm,
+		lowFreq,
+		lowGain,
+		lowBump,
+		lowWide,
+		lowMidFreq,
+		lowMidGain,
+		lowMidQ,
+		highMidFreq,
+		highMidGain,
+		highMidQ,
+		highFreq,
+		highGain,
+		highBump,
+		highWide,
+		highPass,
+		svfFilters,
+		linearPhase,
+		oversampling,
+		antialiasing,
+		lookupTables,
+		midSide,
+		sideInClean,
+		sideInWarm,
+		sideOutClean,
+		sideOutWarm,
+		sideLowFreq,
+		sideLowGain,
+		sideLowBump,
+		sideLowWide,
+		sideLowMidFreq,
+		sideLowMidGain,
+		sideLowMidQ,
+		sideHighMidFreq,
+		sideHighMidGain,
+		sideHighMidQ,
+		sideHighFreq,
+		sideHighGain,
+		sideHighBump,
+		sideHighWide,
+		sideHighPass,
+		lowMidDynamic,
+		lowMidThreshold,
+		lowMidRatio,
+		lowMidAttack,
+		lowMidRelease,
+		highMidDynamic,
+		highMidThreshold,
+		highMidRatio,
+		highMidAttack,
+		highMidRelease,
+		keyInput,
+		numParams
+	};
+
+	enum Group : juce::uint32 {
+		gainGroup = 1 << 0,
+		saturationGroup = 1 << 1,
+		lowGroup = 1 << 2,
+		lowMidGroup = 1 << 3,
+		highMidGroup = 1 << 4,
+		highGroup = 1 << 5,
+		highPassGroup = 1 << 6,
+		backendGroup = 1 << 7,
+		oversamplingGroup = 1 << 8,
+		dynamicsGroup = 1 << 9,
+		allGroups = (1 << 10) - 1
+	};
+
+	explicit ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts)
+	{
+		for (int i = 0; i < numParams; ++i) {
+			sources[i] = apvts.getRawParameterValue(layout[i].id);
+			jassert(sources[i] != nullptr);
+		}
+	}
+
+	// Reads every parameter, returns the groups whose values changed
+	juce::uint32 update() noexcept
+	{
+		auto dirty = pending;
+		pending = 0;
+
+		for (int i = 0; i < numParams; ++i) {
+			auto value = sources[i]->load(std::memory_order_relaxed);
+
+			if (value != values[i]) {
+				values[i] = value;
+				dirty |= layout[i].group;
+			}
+		}
+
+		return dirty;
+	}
+
+	// Force every group to be reported on the next update(), e.g. after prepareToPlay
+	void markAllDirty() noexcept { pending = allGroups; }
+
+	float get(Param param) const noexcept { return values[param]; }
+	bool isOn(Param param) const noexcept { return values[param] >= 0.5f; }
+
+	// The side copy of a saturation or band parameter, for mid/side mode. The
+	// copies are in the groups of their originals.
+	static Param sideOf(Param param) noexcept
+	{
+		switch (param) {
+		case inClean:
+			return sideInClean;
+		case inWarm:
+			return sideInWarm;
+		case outClean:
+			return sideOutClean;
+		case outWarm:
+			return sideOutWarm;
+		default:
+			jassert(param >= lowFreq && param <= highPass);
+			return (Param)(param - lowFreq + sideLowFreq);
+		}
+	}
+
+private:
+	struct Entry {
+		const char* id;
+		juce::uint32 group;
+	};
+
+	static constexpr Entry layout[numParams] = {
+		{ "INGAIN", gainGroup },
+		{ "DRIVE", gainGroup },
+		{ "INCLEAN", saturationGroup },
+		{ "INWARM", saturationGroup },
+		{ "OUTGAIN", gainGroup },
+		{ "OUTCLEAN", saturationGroup },
+		{ "OUTWARM", saturationGroup },
+		{ "LOWFREQ", lowGroup },
+		{ "LOWGAIN", lowGroup },
+		{ "LOWBUMP", lowGroup },
+		{ "LOWWIDE", lowGroup },
+		{ "LOWMIDFREQ", lowMidGroup },
+		{ "LOWMIDGAIN", lowMidGroup },
+		{ "LOWMIDQ", lowMidGroup },
+		{ "HIGHMIDFREQ", highMidGroup },
+		{ "HIGHMIDGAIN", highMidGroup },
+		{ "HIGHMIDQ", highMidGroup },
+		{ "HIGHFREQ", highGroup },
+		{ "HIGHGAIN", highGroup },
+		{ "HIGHBUMP", highGroup },
+		{ "HIGHWIDE", highGroup },
+		{ "HIGHPASS", highPassGroup },
+		{ "SVF", backendGroup },
+		{ "LINEARPHASE", backendGroup },
+		{ "OVERSAMPLING", oversamplingGroup },
+		{ "ANTIALIAS", oversamplingGroup },
+		{ "SHAPER", saturationGroup },
+		{ "MIDSIDE", backendGroup },
+		{ "SIDEINCLEAN", saturationGroup },
+		{ "SIDEINWARM", saturationGroup },
+		{ "SIDEOUTCLEAN", saturationGroup },
+		{ "SIDEOUTWARM", saturationGroup },
+		{ "SIDELOWFREQ", lowGroup },
+		{ "SIDELOWGAIN", lowGroup },
+		{ "SIDELOWBUMP", lowGroup },
+		{ "SIDELOWWIDE", lowGroup },
+		{ "SIDELOWMIDFREQ", lowMidGroup },
+		{ "SIDELOWMIDGAIN", lowMidGroup },
+		{ "SIDELOWMIDQ", lowMidGroup },
+		{ "SIDEHIGHMIDFREQ", highMidGroup },
+		{ "SIDEHIGHMIDGAIN", highMidGroup },
+		{ "SIDEHIGHMIDQ", highMidGroup },
+		{ "SIDEHIGHFREQ", highGroup },
+		{ "SIDEHIGHGAIN", highGroup },
+		{ "SIDEHIGHBUMP", highGroup },
+		{ "SIDEHIGHWIDE", highGroup },
+		{ "SIDEHIGHPASS", highPassGroup },
+		{ "LOWMIDDYN", dynamicsGroup | lowMidGroup },
+		{ "LOWMIDTHRESH", dynamicsGroup },
+		{ "LOWMIDRATIO", dynamicsGroup },
+		{ "LOWMIDATTACK", dynamicsGroup },
+		{ "LOWMIDRELEASE", dynamicsGroup },
+		{ "HIGHMIDDYN", dynamicsGroup | highMidGroup },
+		{ "HIGHMIDTHRESH", dynamicsGroup },
+		{ "HIGHMIDRATIO", dynamicsGroup },
+		{ "HIGHMIDATTACK", dynamicsGroup },
+		{ "HIGHMIDRELEASE", dynamicsGroup },
+		{ "KEYINPUT", dynamicsGroup },
+	};
+
+	std::atomic<float>* sources[numParams] {};
+	float values[numParams] {};
+	juce::uint32 pending = allGroups;
+};
@@ -26,6 +26,10 @@ J13AudioProcessorEditor::J13AudioProcessorEditor(J13AudioProcessor& p)
 	// editor's size to whatever you need it to be.
 	setSize(640, 640); // 400
 
+	for (auto& coeffs : shownCoeffs)
+		coeffs = new juce::dsp::IIR::Coefficients<float>(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+
+	attachControls();
 	createInputControls();
 	createLowControls();
 	createMidControls();
@@ -34,7 +38,8 @@ J13AudioProcessorEditor::J13AudioProcessorEditor(J13AudioProcessor& p)
 
 	// -----------------------------------------------
 	addAndMakeVisible(plotter);
-	startTimer(100);
+	createModeControls();
+	plotCoeffs();
 
 	background = juce::ImageCache::getFromMemory(BinaryData::Background_png, BinaryData::Background_pngSize);
 }
@@ -92,13 +97,6 @@ void J13AudioProcessorEditor::createInputControls()
 	inputWarm.setClickingTogglesState(true);
 	inputBright.setClickingTogglesState(true);
 
-	inputCleanAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "INCLEAN", inputClean);
-	inputWarmAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "INWARM", inputWarm);
-	inputBrightAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "INBRIGHT", inputBright);
-
 	inGainSlider.textFromValueFunction = [](double value) { return juce::String(value, 1); };
 	driveSlider.textFromValueFunction = [](double value) { return juce::String(value, 1); };
 
@@ -115,22 +113,10 @@ void J13AudioProcessorEditor::createLowControls()
 	addAndMakeVisible(lowFreqSlider);
 	addAndMakeVisible(lowGainSlider);
 
-	lowFreqAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "LOWFREQ", lowFreqSlider);
-	lowGainAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "LOWGAIN", lowGainSlider);
-
 	addAndMakeVisible(lowShelf);
 	addAndMakeVisible(lowBump);
 	addAndMakeVisible(lowWide);
 
-	lowShelfAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "LOWSHELF", lowShelf);
-	lowBumpAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "LOWBUMP", lowBump);
-	lowWideAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "LOWWIDE", lowWide);
-
 	lowBump.setRadioGroupId(low, juce::NotificationType::sendNotification);
 	lowShelf.setRadioGroupId(low, juce::NotificationType::sendNotification);
 	lowWide.setRadioGroupId(low, juce::NotificationType::sendNotification);
@@ -146,13 +132,6 @@ void J13AudioProcessorEditor::createLowControls()
 
 	lowGainSlider.textFromValueFunction = [](double value) { return String(value, 1); };
 	lowGainSlider.updateText();
-
-	lowShelf.addListener(this);
-	lowBump.addListener(this);
-	lowWide.addListener(this);
-
-	lowFreqSlider.addListener(this);
-	lowGainSlider.addListener(this);
 }
 
 void J13AudioProcessorEditor::createMidControls()
@@ -166,13 +145,6 @@ void J13AudioProcessorEditor::createMidControls()
 	addAndMakeVisible(lowMidGainSlider);
 	addAndMakeVisible(lowMidQSlider);
 
-	lowMidFreqAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "LOWMIDFREQ", lowMidFreqSlider);
-	lowMidGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "LOWMIDGAIN", lowMidGainSlider);
-	lowMidQAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "LOWMIDQ", lowMidQSlider);
-
 	// -----------------------------------------------
 	highMidFreqSlider.setLookAndFeel(&jLookGain);
 	highMidGainSlider.setLookAndFeel(&jLookFreq);
@@ -182,13 +154,6 @@ void J13AudioProcessorEditor::createMidControls()
 	addAndMakeVisible(highMidGainSlider);
 	addAndMakeVisible(highMidQSlider);
 
-	highMidFreqAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "HIGHMIDFREQ", highMidFreqSlider);
-	highMidGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "HIGHMIDGAIN", highMidGainSlider);
-	highMidQAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "HIGHMIDQ", highMidQSlider);
-
 	lowMidFreqSlider.textFromValueFunction = [](double value) { return juce::String(rint(value)); };
 	highMidFreqSlider.textFromValueFunction = [](double value) { return juce::String(rint(value)); };
 
@@ -205,13 +170,6 @@ void J13AudioProcessorEditor::createMidControls()
 	highMidGainSlider.updateText();
 	lowMidQSlider.updateText();
 	highMidQSlider.updateText();
-
-	lowMidGainSlider.addListener(this);
-	highMidGainSlider.addListener(this);
-	lowMidQSlider.addListener(this);
-	highMidQSlider.addListener(this);
-	lowMidFreqSlider.addListener(this);
-	highMidFreqSlider.addListener(this);
 }
 
 void J13AudioProcessorEditor::createHighControls()
@@ -222,22 +180,10 @@ void J13AudioProcessorEditor::createHighControls()
 	addAndMakeVisible(highFreqSlider);
 	addAndMakeVisible(highGainSlider);
 
-	highFreqAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "HIGHFREQ", highFreqSlider);
-	highGainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "HIGHGAIN", highGainSlider);
-
 	addAndMakeVisible(highShelf);
 	addAndMakeVisible(highBump);
 	addAndMakeVisible(highWide);
 
-	highShelfAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "HIGHSHELF", highShelf);
-	highBumpAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "HIGHBUMP", highBump);
-	highWideAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "HIGHWIDE", highWide);
-
 	highBump.setRadioGroupId(high, juce::NotificationType::sendNotification);
 	highShelf.setRadioGroupId(high, juce::NotificationType::sendNotification);
 	highWide.setRadioGroupId(high, juce::NotificationType::sendNotification);
@@ -250,13 +196,6 @@ void J13AudioProcessorEditor::createHighControls()
 
 	highFreqSlider.textFromValueFunction = [](double value) { return juce::String(rint(value)); };
 	highFreqSlider.updateText();
-
-	highShelf.addListener(this);
-	highBump.addListener(this);
-	highWide.addListener(this);
-
-	highFreqSlider.addListener(this);
-	highGainSlider.addListener(this);
 }
 
 void J13AudioProcessorEditor::createOutputControls()
@@ -280,23 +219,93 @@ void J13AudioProcessorEditor::createOutputControls()
 	outputWarm.setClickingTogglesState(true);
 	outputThick.setClickingTogglesState(true);
 
-	outputCleanAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "OUTCLEAN", outputClean);
-	outputWarmAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "OUTWARM", outputWarm);
-	outputThickAttachment
-		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "OUTTHICK", outputThick);
-
 	highPassSlider.setLookAndFeel(&jLookRes);
 	addAndMakeVisible(highPassSlider);
 
-	highPassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
-		audioProcessor.apvts, "HIGHPASS", highPassSlider);
-
 	highPassSlider.textFromValueFunction = [](double value) { return juce::String(rint(value)); };
 	highPassSlider.updateText();
 }
 
+void J13AudioProcessorEditor::createModeControls()
+{
+	addAndMakeVisible(midSide);
+	addAndMakeVisible(editMid);
+	addAndMakeVisible(editSide);
+
+	midSide.setClickingTogglesState(true);
+
+	midSideAttachment
+		= std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.apvts, "MIDSIDE", midSide);
+
+	editMid.setRadioGroupId(edit, juce::NotificationType::dontSendNotification);
+	editSide.setRadioGroupId(edit, juce::NotificationType::dontSendNotification);
+
+	editMid.setClickingTogglesState(true);
+	editSide.setClickingTogglesState(true);
+
+	editMid.setToggleState(true, juce::NotificationType::dontSendNotification);
+
+	editMid.addListener(this);
+	editSide.addListener(this);
+
+	addAndMakeVisible(showTimings);
+	addChildComponent(stageReadout);
+	showTimings.setClickingTogglesState(true);
+	showTimings.addListener(this);
+}
+
+void J13AudioProcessorEditor::attachControls()
+{
+	using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+	using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+
+	auto& apvts = audioProcessor.apvts;
+	juce::String prefix = editingSide ? "SIDE" : "";
+
+	// the old attachments have to go first, so they stop driving the controls
+	for (auto* attachment : { &inputCleanAttachment, &inputWarmAttachment, &inputBrightAttachment, &outputCleanAttachment,
+			 &outputWarmAttachment, &outputThickAttachment, &lowShelfAttachment, &lowBumpAttachment, &lowWideAttachment,
+			 &highShelfAttachment, &highBumpAttachment, &highWideAttachment })
+		attachment->reset();
+
+	for (auto* attachment : { &lowFreqAttachment, &lowGainAttachment, &lowMidFreqAttachment, &lowMidGainAttachment,
+			 &lowMidQAttachment, &highMidFreqAttachment, &highMidGainAttachment, &highMidQAttachment, &highFreqAttachment,
+			 &highGainAttachment, &highPassAttachment })
+		attachment->reset();
+
+	inputCleanAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "INCLEAN", inputClean);
+	inputWarmAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "INWARM", inputWarm);
+	inputBrightAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "INBRIGHT", inputBright);
+
+	lowFreqAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "LOWFREQ", lowFreqSlider);
+	lowGainAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "LOWGAIN", lowGainSlider);
+
+	lowShelfAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "LOWSHELF", lowShelf);
+	lowBumpAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "LOWBUMP", lowBump);
+	lowWideAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "LOWWIDE", lowWide);
+
+	lowMidFreqAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "LOWMIDFREQ", lowMidFreqSlider);
+	lowMidGainAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "LOWMIDGAIN", lowMidGainSlider);
+	lowMidQAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "LOWMIDQ", lowMidQSlider);
+
+	highMidFreqAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "HIGHMIDFREQ", highMidFreqSlider);
+	highMidGainAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "HIGHMIDGAIN", highMidGainSlider);
+	highMidQAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "HIGHMIDQ", highMidQSlider);
+
+	highFreqAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "HIGHFREQ", highFreqSlider);
+	highGainAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "HIGHGAIN", highGainSlider);
+
+	highShelfAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "HIGHSHELF", highShelf);
+	highBumpAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "HIGHBUMP", highBump);
+	highWideAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "HIGHWIDE", highWide);
+
+	outputCleanAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "OUTCLEAN", outputClean);
+	outputWarmAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "OUTWARM", outputWarm);
+	outputThickAttachment = std::make_unique<ButtonAttachment>(apvts, prefix + "OUTTHICK", outputThick);
+
+	highPassAttachment = std::make_unique<SliderAttachment>(apvts, prefix + "HIGHPASS", highPassSlider);
+}
+
 void J13AudioProcessorEditor::paint(juce::Graphics& g)
 {
 	// (Our component is opaque, so we must completely fill the background with a
@@ -315,14 +324,6 @@ void J13AudioProcessorEditor::paint(juce::Graphics& g)
 	g.fillRect(midBottomDivider);
 	g.fillRect(midMiddleDivider);
 	g.fillRect(midTopDivider);
-
-	checkCoeffs();
-
-	if (needRepaint) {
-		plotter.repaint(plotSection);
-		needRepaint = false;
-		saveCoeffs();
-	}
 }
 
 juce::Rectangle<int> J13AudioProcessorEditor::shrinkArea(juce::Rectangle<int> areaOld)
@@ -339,6 +340,7 @@ juce::Rectangle<int> J13AudioProcessorEditor::shrinkArea(juce::Rectangle<int> ar
 void J13AudioProcessorEditor::layoutSections()
 {
 	plotSection = area.removeFromTop(area.getHeight() / 2.4);
+	modeSection = plotSection.removeFromTop(buttonHeight + 6);
 
 	area.removeFromTop(10);
 	area.removeFromBottom(10);
@@ -495,6 +497,15 @@ void J13AudioProcessorEditor::layoutOutput()
 	outputThickArea = centerButtonArea(outputThickArea);
 }
 
+void J13AudioProcessorEditor::layoutMode()
+{
+	midSideArea = centerButtonArea(modeSection.removeFromLeft(buttonWidth + 8));
+	modeSection.removeFromLeft(12);
+	editMidArea = centerButtonArea(modeSection.removeFromLeft(buttonWidth + 8));
+	editSideArea = centerButtonArea(modeSection.removeFromLeft(buttonWidth + 8));
+	showTimingsArea = centerButtonArea(modeSection.removeFromRight(buttonWidth + 8));
+}
+
 void J13AudioProcessorEditor::layoutSizes()
 {
 	area = getLocalBounds();
@@ -511,6 +522,7 @@ void J13AudioProcessorEditor::layoutSizes()
 	layoutMid();
 	layoutHigh();
 	layoutOutput();
+	layoutMode();
 }
 
 void J13AudioProcessorEditor::resized()
@@ -528,6 +540,14 @@ void J13AudioProcessorEditor::resized()
 	// subcomponents in your editor..
 	plotter.setBounds(plotSection);
 
+	midSide.setBounds(midSideArea);
+	editMid.setBounds(editMidArea);
+	editSide.setBounds(editSideArea);
+	showTimings.setBounds(showTimingsArea);
+
+	stageReadout.setBounds(plotSection.getRight() - StageReadout::width - 4, plotSection.getY() + 4, StageReadout::width,
+		StageReadout::numRows * StageReadout::rowHeight + 8);
+
 	inGainSlider.setBounds(inGainArea);
 	inputClean.setBounds(inputCleanArea);
 	inputWarm.setBounds(inputWarmArea);
@@ -585,66 +605,46 @@ void J13AudioProcessorEditor::resized()
 	highPassSlider.showLabel(*this);
 }
 
-void J13AudioProcessorEditor::timerCallback()
+void J13AudioProcessorEditor::updatePlot()
 {
-	stopTimer();
-
-	auto x = audioProcessor.getCoeffs(0);
-	if (x == nullptr) {
-		if (!isTimerRunning())
-			startTimer(100);
-	} else {
-		plotter.clearCoeffs();
-
-		plotter.addCoeffs(x);
-		plotter.addCoeffs(audioProcessor.getCoeffs(1));
-		plotter.addCoeffs(audioProcessor.getCoeffs(2));
-		plotter.addCoeffs(audioProcessor.getCoeffs(3));
-		plotter.addCoeffs(audioProcessor.getCoeffs(4));
-
+	if (audioProcessor.getCoefficientSnapshot().getVersion() != shownVersion) {
 		saveCoeffs();
-		needRepaint = true;
-		plotter.repaint(plotSection);
+		plotter.repaint();
 	}
 }
 
-void J13AudioProcessorEditor::sliderValueChanged(Slider* slider) { needRepaint = true; }
+// Plot the bands that the controls are editing, mid or side
+void J13AudioProcessorEditor::plotCoeffs()
+{
+	saveCoeffs();
+	plotter.clearCoeffs();
 
-void J13AudioProcessorEditor::buttonClicked(Button*) { needRepaint = true; }
+	for (auto& coeffs : shownCoeffs)
+		plotter.addCoeffs(coeffs);
 
-// Save a copy of the all coeff values to be compared later
-void J13AudioProcessorEditor::saveCoeffs()
+	plotter.repaint();
+}
+
+void J13AudioProcessorEditor::buttonClicked(Button* button)
 {
-	if (audioProcessor.getCoeffs(0) == nullptr) {
-		return;
+	if ((button == &editMid || button == &editSide) && editSide.getToggleState() != editingSide) {
+		editingSide = editSide.getToggleState();
+		attachControls();
+		plotCoeffs();
 	}
 
-	for (auto filterNum = 0; filterNum < 5; ++filterNum) {
-		auto filter = audioProcessor.getCoeffs(filterNum)->getRawCoefficients();
-		for (auto coeffNum = 0; coeffNum < 6; ++coeffNum) {
-			oldCoeff[filterNum][coeffNum] = filter[coeffNum];
-		}
-	}
+	if (button == &showTimings)
+		stageReadout.setVisible(showTimings.getToggleState());
 }
 
-// If any coeff values have changed then set the needrepaint
-// since there are smoothers involved, use a window abs(old-new) > limit
-void J13AudioProcessorEditor::checkCoeffs()
+// Copy the latest published coeff values into the plotted ones
+void J13AudioProcessorEditor::saveCoeffs()
 {
-	auto limit = 0.0001f;
-
-	if (audioProcessor.getCoeffs(0) == nullptr) {
-		return;
-	}
+	CoefficientSnapshot::Coefficients coefficients;
+	shownVersion = audioProcessor.getCoefficientSnapshot().read(coefficients);
 
-	for (auto filterNum = 0; filterNum < 5; ++filterNum) {
-		auto filter = audioProcessor.getCoeffs(filterNum)->getRawCoefficients();
-		for (auto coeffNum = 0; coeffNum < 6; ++coeffNum) {
-			float diff = oldCoeff[filterNum][coeffNum] - filter[coeffNum];
-			float adiff = abs(diff);
-			if (adiff > limit) {
-				needRepaint = true;
-			}
-		}
+	for (auto filterNum = 0; filterNum < CoefficientSnapshot::numBands; ++filterNum) {
+		auto* band = coefficients.bands[editingSide ? 1 : 0][filterNum];
+		std::copy(band, band + CoefficientSnapshot::numCoeffs, shownCoeffs[filterNum]->getRawCoefficients());
 	}
 }
@@ -10,6 +10,7 @@
 
 #include "FreqPlotter.h"
 #include "PluginProcessor.h"
+#include "StageReadout.h"
 #include "jLookAndFeel.h"
 #include "jRotary.h"
 
@@ -17,9 +18,7 @@
 
 
 class J13AudioProcessorEditor : public juce::AudioProcessorEditor,
-								public juce::Timer,
-								public juce::Button::Listener,
-								public juce::Slider::Listener
+								public juce::Button::Listener
 
 {
 public:
@@ -84,6 +83,15 @@ private:
 	juce::TextButton outputWarm { "Warm" };
 	juce::TextButton outputThick { "Thick" };
 
+	// Mid/side mode, and which of the two the band and saturation controls edit
+	juce::TextButton midSide { "M/S" };
+	juce::TextButton editMid { "Mid" };
+	juce::TextButton editSide { "Side" };
+	bool editingSide = false;
+
+	// Shows the DSP timings over the plot
+	juce::TextButton showTimings { "CPU" };
+
 	// Fonts
 	juce::Font labelFont { LABELFONTSIZE };
 
@@ -126,15 +134,23 @@ private:
 	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> highBumpAttachment;
 	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> highWideAttachment;
 
+	std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> midSideAttachment;
+
 	// Frequency Response Plotter
-	bool needRepaint;
 	FreqPlotter plotter;
+	StageReadout stageReadout { audioProcessor.getStageTimers() };
+
+	// Once per display frame: repaints the plot, and only the plot, when the
+	// processor has published new coefficients. Each knob repaints only itself
+	// when its value changes.
+	juce::VBlankAttachment vBlank { this, [this] { updatePlot(); } };
 
 	// Total available to work with
 	juce::Rectangle<int> area;
 
 	// Major sections
 	juce::Rectangle<int> plotSection;
+	juce::Rectangle<int> modeSection;
 	juce::Rectangle<int> inputSection;
 	juce::Rectangle<int> lowSection;
 	juce::Rectangle<int> midSection;
@@ -190,13 +206,17 @@ private:
 
 	juce::Rectangle<int> highPassArea;
 
+	juce::Rectangle<int> midSideArea;
+	juce::Rectangle<int> editMidArea;
+	juce::Rectangle<int> editSideArea;
+	juce::Rectangle<int> showTimingsArea;
+
 	// layout helpers
 	int stripWidth;
 	int stripHeight;
 	int controlHeight;
 
-	//
-	void timerCallback() override;
+	void updatePlot();
 
 	void layoutSizes();
 	void layoutSections();
@@ -205,6 +225,7 @@ private:
 	void layoutMid();
 	void layoutHigh();
 	void layoutOutput();
+	void layoutMode();
 
 	juce::Rectangle<int> shrinkArea(juce::Rectangle<int> area);
 
@@ -214,6 +235,10 @@ private:
 	void createMidControls();
 	void createHighControls();
 	void createOutputControls();
+	void createModeControls();
+
+	// (Re)attaches the band and saturation controls to the mid or side parameters
+	void attachControls();
 
 	static juce::String formatValue(double value)
 	{
@@ -229,15 +254,17 @@ private:
 
 	juce::Rectangle<int> centerButtonArea(juce::Rectangle<int> buttonArea);
 
-	enum JRadioGroups { input = 1, low = 2, high = 3, output = 4 };
+	enum JRadioGroups { input = 1, low = 2, high = 3, output = 4, edit = 5 };
 
-	void sliderValueChanged(Slider* slider);
 	void buttonClicked(Button*);
 
-	std::array<std::array<float, 6>, 5> oldCoeff;
+	// The plotted coefficients, copies from the processor's CoefficientSnapshot
+	juce::dsp::IIR::Coefficients<float>::Ptr shownCoeffs[CoefficientSnapshot::numBands];
+	juce::uint32 shownVersion = 0;
+
+	void plotCoeffs();
 
 	void saveCoeffs();
-	void checkCoeffs();
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(J13AudioProcessorEditor)
 };
@@ -10,47 +10,120 @@
 
 
 #include "PluginProcessor.h"
-#include "Filters.h"
-#include "GainProcessor.h"
 #include "PluginEditor.h"
-#include "Saturation.h"
 
 
 J13AudioProcessor::J13AudioProcessor()
 	: AudioProcessor(BusesProperties()
 						 .withInput("Input", juce::AudioChannelSet::stereo(), true)
-						 .withOutput("Output", juce::AudioChannelSet::stereo(), true))
+						 .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+						 .withInput("Sidechain", juce::AudioChannelSet::stereo(), false))
 	, apvts(*this, nullptr, "Parameters", createParameters())
-	, mainProcessor(new juce::AudioProcessorGraph())
+	, snapshot(apvts)
 {
+	strip.setTimers(&stageTimers);
 }
 
 J13AudioProcessor::~J13AudioProcessor() { }
 
 bool J13AudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-	// This is the place where you check if the layout is supported.
-	if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-		&& layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+	// Any layout the strip has lanes for: mono, stereo, LCR, 5.1 up to 7.1.4 beds
+	auto output = layouts.getMainOutputChannelSet();
+
+	if (output.isDisabled() || output.size() > ChannelStrip::maxChannels)
 		return false;
 
 	// This checks if the input layout matches the output layout
 	if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
 		return false;
 
+	// The key input can be off, mono, or laid out like the main bus
+	if (layouts.inputBuses.size() > keyBus) {
+		auto key = layouts.getChannelSet(true, keyBus);
+
+		if (!key.isDisabled() && key != juce::AudioChannelSet::mono() && key != output)
+			return false;
+	}
+
 	return true;
 }
 
-void J13AudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void J13AudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) { processSamples(buffer); }
+
+void J13AudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&) { processSamples(buffer); }
+
+template <typename SampleType>
+void J13AudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
 {
 	juce::ScopedNoDenormals noDenormals;
 
+	// The stage timings are a replay: while the timers are enabled, a copy of
+	// the last tile runs through each stage again every probeSeconds. That is
+	// done ahead of the block timing, so it does not count towards the block.
+	if (stageTimers.isEnabled() && !idling) {
+		samplesToNextProbe -= buffer.getNumSamples();
+
+		if (samplesToNextProbe <= 0) {
+			samplesToNextProbe = juce::roundToInt(probeSeconds * sampleRateX);
+			strip.probeStages<SampleType>(stageTimers);
+		}
+	}
+
+	StageTimers::Scope blockTimer(stageTimers, StageTimers::block, buffer.getNumSamples());
+
 	for (int i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
 		buffer.clear(i, 0, buffer.getNumSamples());
 
-	updateGraph();
+	pendingGroups |= snapshot.update();
+
+	auto numSamples = buffer.getNumSamples();
+
+	// The key input shares the host buffer, after the main channels
+	auto mainBuffer = getBusBuffer(buffer, true, 0);
+	auto useKey = snapshot.isOn(ParameterSnapshot::keyInput) && getBusCount(true) > keyBus
+		&& getBus(true, keyBus)->isEnabled() && getBus(true, keyBus)->getNumberOfChannels() > 0;
+	auto key = useKey ? getBusBuffer(buffer, true, keyBus) : juce::AudioBuffer<SampleType>();
+
+	// Once the input has been silent for longer than the strip's tail the
+	// output is silent too, and the strip is skipped until input returns.
+	// Settings still follow the parameters meanwhile.
+	auto silent = mainBuffer.getMagnitude(0, numSamples) <= (SampleType)silenceThreshold;
+	silentSamples = silent ? silentSamples + numSamples : 0;
+
+	auto idle = silent && silentSamples - numSamples >= strip.getTailInSamples();
+
+	if (idling && !idle)
+		strip.reset();
 
-	mainProcessor->processBlock(buffer, midiMessages);
+	idling = idle;
+
+	// Settings are advanced every controlInterval samples of the stream, not
+	// once per host block, so automation sounds the same at any buffer size.
+	auto interval = controlInterval.load(std::memory_order_relaxed);
+
+	if (interval == 0)
+		samplesToNextControl = 0;
+
+	for (int start = 0; start < numSamples;) {
+		if (samplesToNextControl == 0) {
+			samplesToNextControl = interval > 0 ? interval : numSamples;
+
+			StageTimers::Scope timer(stageTimers, StageTimers::control, samplesToNextControl);
+			updateGraph(samplesToNextControl);
+		}
+
+		auto length = juce::jmin(numSamples - start, samplesToNextControl);
+
+		if (!idle)
+			strip.process(mainBuffer, start, length, useKey ? &key : nullptr);
+
+		start += length;
+		samplesToNextControl -= length;
+	}
+
+	if (idle)
+		buffer.clear();
 }
 
 juce::AudioProcessorEditor* J13AudioProcessor::createEditor() { return new J13AudioProcessorEditor(*this); }
@@ -96,6 +169,24 @@ void J13AudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 	if (xmlState.get() != nullptr)
 		if (xmlState->hasTagName(apvts.state.getType()))
 			apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+
+	setUserCurve(0, apvts.state.getProperty(userCurveIds[0]).toString());
+	setUserCurve(1, apvts.state.getProperty(userCurveIds[1]).toString());
+}
+
+void J13AudioProcessor::setUserCurve(int stage, const juce::String& name)
+{
+	jassert(stage == 0 || stage == 1);
+
+	// A name that isn't installed on this machine is kept in the state, so the
+	// curve comes back once the file is, but plays the built in curve meanwhile
+	apvts.state.setProperty(userCurveIds[stage], name, nullptr);
+	userCurves[stage].store(name.isEmpty() ? nullptr : saturationTables->findUserCurve(name));
+}
+
+juce::String J13AudioProcessor::getUserCurve(int stage) const
+{
+	return apvts.state.getProperty(userCurveIds[stage]).toString();
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter() { return new J13AudioProcessor(); }
@@ -139,333 +230,417 @@ juce::AudioProcessorValueTreeState::ParameterLayout J13AudioProcessor::createPar
 
 	params.push_back(std::make_unique<juce::AudioParameterFloat>("HIGHPASS", "High Pass", 20.0f, 250.0f, 20.0f));
 
-	return { params.begin(), params.end() };
-}
-
-void J13AudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
-{
-	J13AudioProcessor::sampleRateX = sampleRate;
+	params.push_back(std::make_unique<juce::AudioParameterBool>("SVF", "SVF Filters", false));
+	params.push_back(std::make_unique<juce::AudioParameterBool>("LINEARPHASE", "Linear Phase EQ", false));
+	params.push_back(std::make_unique<juce::AudioParameterChoice>(
+		"OVERSAMPLING", "Oversampling", juce::StringArray { "1x", "2x", "4x", "8x" }, 0));
+	params.push_back(std::make_unique<juce::AudioParameterChoice>(
+		"ANTIALIAS", "Antialiasing", juce::StringArray { "Off", "ADAA 1st Order", "ADAA 2nd Order" }, 0));
+	params.push_back(std::make_unique<juce::AudioParameterChoice>(
+		"SHAPER", "Saturation Shaper", juce::StringArray { "Direct", "Lookup Table" }, 0));
+
+	// Dynamics of the two mid peaks, shared by mid and side
+	for (auto [id, name] : { std::pair { "LOWMID", "Low Mid" }, std::pair { "HIGHMID", "High Mid" } }) {
+		auto prefix = juce::String(id);
+		auto label = juce::String(name);
+
+		params.push_back(std::make_unique<juce::AudioParameterBool>(prefix + "DYN", label + " Dynamic", false));
+		params.push_back(std::make_unique<juce::AudioParameterFloat>(
+			prefix + "THRESH", label + " Threshold", -60.0f, 0.0f, -24.0f));
+		params.push_back(std::make_unique<juce::AudioParameterFloat>(
+			prefix + "RATIO", label + " Ratio", juce::NormalisableRange<float>(1.0f, 10.0f, 0.0f, 0.5f), 2.0f));
+		params.push_back(std::make_unique<juce::AudioParameterFloat>(
+			prefix + "ATTACK", label + " Attack", juce::NormalisableRange<float>(0.1f, 100.0f, 0.0f, 0.4f), 5.0f));
+		params.push_back(std::make_unique<juce::AudioParameterFloat>(
+			prefix + "RELEASE", label + " Release", juce::NormalisableRange<float>(5.0f, 1000.0f, 0.0f, 0.4f), 100.0f));
+	}
 
-	mainProcessor->setPlayConfigDetails(getMainBusNumInputChannels(), getMainBusNumOutputChannels(), sampleRate, samplesPerBlock);
-	mainProcessor->prepareToPlay(sampleRate, samplesPerBlock);
+	params.push_back(std::make_unique<juce::AudioParameterBool>("KEYINPUT", "Sidechain Key", false));
 
-	initialiseGraph();
+	// Mid/side mode, and a side copy of every saturation and band parameter
+	// above, with the same range and default
+	auto midSide = std::make_unique<juce::AudioProcessorParameterGroup>("MIDSIDEGROUP", "Mid/Side", "|");
+	midSide->addChild(std::make_unique<juce::AudioParameterBool>("MIDSIDE", "Mid/Side", false));
 
-	smoothInGain.reset(sampleRate, 0.25f);
-	smoothDrive.reset(sampleRate, 0.25f);
-	smoothOutGain.reset(sampleRate, 0.25f);
+	for (auto& param : params) {
+		if (!isSideParameter(param->paramID))
+			continue;
 
-	smoothLowFreq.reset(sampleRate, 0.25f);
-	smoothLowGain.reset(sampleRate, 0.25f);
-	smoothLowQ.reset(sampleRate, 0.25f);
+		auto id = "SIDE" + param->paramID;
+		auto name = "Side " + param->name;
+		auto defaultValue = param->convertFrom0to1(param->getDefaultValue());
 
-	smoothLowMidFreq.reset(sampleRate, 0.25f);
-	smoothLowMidGain.reset(sampleRate, 0.25f);
-	smoothLowMidQ.reset(sampleRate, 0.25f);
+		if (dynamic_cast<juce::AudioParameterBool*>(param.get()) != nullptr) {
+			midSide->addChild(std::make_unique<juce::AudioParameterBool>(id, name, defaultValue >= 0.5f));
+		} else {
+			midSide->addChild(
+				std::make_unique<juce::AudioParameterFloat>(id, name, param->getNormalisableRange(), defaultValue));
+		}
+	}
 
-	smoothHighMidFreq.reset(sampleRate, 0.25f);
-	smoothHighMidGain.reset(sampleRate, 0.25f);
-	smoothHighMidQ.reset(sampleRate, 0.25f);
+	// The layout takes ownership of params, so the copies are made first
+	juce::AudioProcessorValueTreeState::ParameterLayout layout { params.begin(), params.end() };
+	layout.add(std::move(midSide));
 
-	smoothHighFreq.reset(sampleRate, 0.25f);
-	smoothHighGain.reset(sampleRate, 0.25f);
-	smoothHighQ.reset(sampleRate, 0.25f);
+	return layout;
 }
 
-void J13AudioProcessor::initialiseGraph()
+bool J13AudioProcessor::isSideParameter(const juce::String& paramID)
 {
-	mainProcessor->clear();
-
-	audioInputNode = mainProcessor->addNode(std::make_unique<AudioGraphIOProcessor>(AudioGraphIOProcessor::audioInputNode));
-	audioOutputNode = mainProcessor->addNode(std::make_unique<AudioGraphIOProcessor>(AudioGraphIOProcessor::audioOutputNode));
-	midiInputNode = mainProcessor->addNode(std::make_unique<AudioGraphIOProcessor>(AudioGraphIOProcessor::midiInputNode));
-	midiOutputNode = mainProcessor->addNode(std::make_unique<AudioGraphIOProcessor>(AudioGraphIOProcessor::midiOutputNode));
-
-	inputGainNode = mainProcessor->addNode(std::make_unique<GainProcessor>());
-	outputGainNode = mainProcessor->addNode(std::make_unique<GainProcessor>());
-	driveNode = mainProcessor->addNode(std::make_unique<GainProcessor>());
-	driveOffsetNode = mainProcessor->addNode(std::make_unique<GainProcessor>());
+	static const juce::StringArray ids { "INCLEAN", "INWARM", "INBRIGHT", "OUTCLEAN", "OUTWARM", "OUTTHICK", "LOWFREQ",
+		"LOWGAIN", "LOWBUMP", "LOWSHELF", "LOWWIDE", "LOWMIDFREQ", "LOWMIDGAIN", "LOWMIDQ", "HIGHMIDFREQ", "HIGHMIDGAIN",
+		"HIGHMIDQ", "HIGHFREQ", "HIGHGAIN", "HIGHBUMP", "HIGHSHELF", "HIGHWIDE", "HIGHPASS" };
 
-	inSaturationNode = mainProcessor->addNode(std::make_unique<SaturationProcessor>());
-	outSaturationNode = mainProcessor->addNode(std::make_unique<SaturationProcessor>());
-
-	highShelfNode = mainProcessor->addNode(std::make_unique<HighShelfProcessor>());
-	highMidPeakNode = mainProcessor->addNode(std::make_unique<PeakProcessor>());
-	lowMidPeakNode = mainProcessor->addNode(std::make_unique<PeakProcessor>());
-	lowShelfNode = mainProcessor->addNode(std::make_unique<LowShelfProcessor>());
-	highPassNode = mainProcessor->addNode(std::make_unique<HighPassProcessor>());
-
-	connectAudioNodes();
-	connectMidiNodes();
+	return ids.contains(paramID);
 }
 
-void J13AudioProcessor::updateGain(juce::StringRef ParameterID, juce::SmoothedValue<float>* smoother, Node::Ptr node)
+void J13AudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	auto new_value = (apvts.getRawParameterValue(ParameterID))->load();
+	J13AudioProcessor::sampleRateX = sampleRate;
 
-	smoother->setTargetValue(new_value);
+	strip.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+	snapshot.update();
+	snapshot.markAllDirty();
+	samplesToNextControl = 0;
+	silentSamples = 0;
+	idling = false;
+	samplesToNextProbe = 0;
+	stageTimers.setSampleRate(sampleRate);
+
+	// Known before the first block, so the host can compensate from the start
+	strip.setOversampling(juce::roundToInt(apvts.getRawParameterValue("OVERSAMPLING")->load()));
+	strip.setAntialiasing(
+		(SaturationProcessor::Antialiasing)juce::roundToInt(apvts.getRawParameterValue("ANTIALIAS")->load()));
+	strip.setLinearPhase(apvts.getRawParameterValue("LINEARPHASE")->load() >= 0.5f);
+	strip.setMidSide(apvts.getRawParameterValue("MIDSIDE")->load() >= 0.5f);
+
+	for (int set = 0; set < 2; ++set)
+		updateSaturation(set);
+
+	latencySamples = strip.getLatencyInSamples();
+	cancelPendingUpdate();
+	handleAsyncUpdate();
+
+	smoothInGain.reset(sampleRate, 0.25f);
+	smoothDrive.reset(sampleRate, 0.25f);
+	smoothOutGain.reset(sampleRate, 0.25f);
 
-	((GainProcessor*)node.get()->getProcessor())->updateGain(smoother->getNextValue());
+	for (auto& smoothers : bandSmoothers)
+		smoothers.reset(sampleRate, 0.25f);
 }
 
-void J13AudioProcessor::updateGraph()
+void J13AudioProcessor::updateGraph(int numSamples)
 {
 	// see https://www.youtube.com/watch?v=xgoSzXgUPpc and theaudioprogrammer.com
 	// for how this works
+	//
+	// Called once per control interval of numSamples. Only the groups whose
+	// parameters moved, or whose smoothers are still ramping, are touched.
+	// On a static mix this does nothing.
 	//-------------------------------------------------------------
 
-	auto skipSize = getBlockSize() - 1;
+	auto dirty = pendingGroups;
+	pendingGroups = 0;
 
-	updateGain("INGAIN", &smoothInGain, inputGainNode);
-	smoothInGain.skip(skipSize);
+	auto skipSize = numSamples - 1;
 
-	updateGain("DRIVE", &smoothDrive, driveNode);
-	((GainProcessor*)driveOffsetNode.get()->getProcessor())->updateGain(2.0f - smoothDrive.getCurrentValue());
-	smoothDrive.skip(skipSize);
+	// Switching filter backend needs every band designed again in the new form,
+	// and entering mid/side mode needs the side stages brought up to date
+	if (dirty & ParameterSnapshot::backendGroup) {
+		auto wasMidSide = strip.isMidSide();
 
-	updateGain("OUTGAIN", &smoothOutGain, outputGainNode);
-	smoothOutGain.skip(skipSize);
+		strip.setSvfBackend(snapshot.isOn(ParameterSnapshot::svfFilters));
+		strip.setLinearPhase(snapshot.isOn(ParameterSnapshot::linearPhase));
+		strip.setMidSide(snapshot.isOn(ParameterSnapshot::midSide));
+		dirty |= ParameterSnapshot::saturationGroup | ParameterSnapshot::lowGroup | ParameterSnapshot::lowMidGroup
+			| ParameterSnapshot::highMidGroup | ParameterSnapshot::highGroup | ParameterSnapshot::highPassGroup;
 
-	//-------------------------------------------------------------
-	auto inClean = (apvts.getRawParameterValue("INCLEAN"))->load();
-	auto inWarm = (apvts.getRawParameterValue("INWARM"))->load();
-	// auto inBright = (apvts.getRawParameterValue("INBRIGHT"))->load();
-
-	if (inClean) {
-		((SaturationProcessor*)inSaturationNode.get()->getProcessor())->setSaturationType(SaturationProcessor::clean);
-	} else if (inWarm) {
-		((SaturationProcessor*)inSaturationNode.get()->getProcessor())->setSaturationType(SaturationProcessor::warm);
-	} else {
-		((SaturationProcessor*)inSaturationNode.get()->getProcessor())->setSaturationType(SaturationProcessor::bright);
+		// The side smoothers were left wherever M/S was last turned off, so
+		// they start on their parameters instead of ramping from there
+		if (strip.isMidSide() && !wasMidSide) {
+			updateBands(1, ParameterSnapshot::allGroups, 0);
+			bandSmoothers[1].snapToTargets();
+		}
 	}
 
-	//-------------------------------------------------------------
-	auto outClean = (apvts.getRawParameterValue("OUTCLEAN"))->load();
-	auto outWarm = (apvts.getRawParameterValue("OUTWARM"))->load();
-	// auto outThick = (apvts.getRawParameterValue("OUTTHICK"))->load();
-
-	if (outClean) {
-		((SaturationProcessor*)outSaturationNode.get()->getProcessor())->setSaturationType(SaturationProcessor::clean);
-	} else if (outWarm) {
-		((SaturationProcessor*)outSaturationNode.get()->getProcessor())->setSaturationType(SaturationProcessor::warm);
-	} else {
-		((SaturationProcessor*)outSaturationNode.get()->getProcessor())->setSaturationType(SaturationProcessor::thick);
+	// A peak switched to or from dynamic is designed again in its new form,
+	// its switch is also in the group of its band
+	if (dirty & ParameterSnapshot::dynamicsGroup)
+		updateDynamics();
+
+	if ((dirty & ParameterSnapshot::gainGroup) || smoothInGain.isSmoothing() || smoothDrive.isSmoothing()
+		|| smoothOutGain.isSmoothing()) {
+		smoothInGain.setTargetValue(snapshot.get(ParameterSnapshot::inGain));
+		smoothDrive.setTargetValue(snapshot.get(ParameterSnapshot::drive));
+		smoothOutGain.setTargetValue(snapshot.get(ParameterSnapshot::outGain));
+
+		strip.setGains(smoothInGain.getNextValue(), smoothDrive.getNextValue(), smoothOutGain.getNextValue());
+
+		smoothInGain.skip(skipSize);
+		smoothDrive.skip(skipSize);
+		smoothOutGain.skip(skipSize);
 	}
 
 	//-------------------------------------------------------------
-	auto lowfreq = (apvts.getRawParameterValue("LOWFREQ"))->load();
-	smoothLowFreq.setTargetValue(lowfreq);
+	if (dirty & ParameterSnapshot::oversamplingGroup) {
+		strip.setOversampling(juce::roundToInt(snapshot.get(ParameterSnapshot::oversampling)));
+		strip.setAntialiasing(
+			(SaturationProcessor::Antialiasing)juce::roundToInt(snapshot.get(ParameterSnapshot::antialiasing)));
+	}
 
-	auto lowgainDb = (apvts.getRawParameterValue("LOWGAIN"))->load();
-	auto lowgain = juce::Decibels::decibelsToGain(lowgainDb);
+	// User curves are set from the message thread, see setUserCurve(). Clean bypasses them.
+	for (int set = 0; set < 2; ++set) {
+		auto& stages = set == 0 ? strip.primary : strip.side;
+		auto isClean = [this, set](ParameterSnapshot::Param p) {
+			return snapshot.isOn(set == 0 ? p : ParameterSnapshot::sideOf(p));
+		};
 
-	if (lowgain < 0.1f) {
-		lowgain = 0.1f;
+		stages.inSaturation.setUserCurve(isClean(ParameterSnapshot::inClean) ? nullptr : userCurves[0].load());
+		stages.outSaturation.setUserCurve(isClean(ParameterSnapshot::outClean) ? nullptr : userCurves[1].load());
 	}
 
-	smoothLowGain.setTargetValue(lowgain);
-
-	// auto lowShelf = (apvts.getRawParameterValue("LOWSHELF"))->load();
-	auto lowBump = (apvts.getRawParameterValue("LOWBUMP"))->load();
-	auto lowWide = (apvts.getRawParameterValue("LOWWIDE"))->load();
+	//-------------------------------------------------------------
+	// The side stages only follow their parameters in mid/side mode
+	auto numSets = strip.isMidSide() ? 2 : 1;
 
-	float lowQ;
+	for (int set = 0; set < numSets; ++set) {
+		if (dirty & ParameterSnapshot::saturationGroup)
+			updateSaturation(set);
 
-	if (lowBump) {
-		if (smoothLowGain.getCurrentValue() > 1.0f) {
-			lowQ = 1.1f;
-		} else {
-			lowQ = 1.4f;
-		}
-	} else if (lowWide) {
-		lowQ = 0.4f;
-	} else {
-		lowQ = 0.7f;
+		updateBands(set, dirty, skipSize);
 	}
 
-	smoothLowQ.setTargetValue(lowQ);
+	// A clean saturation drops its ADAA delay, see ChannelStrip::getLatencyInSamples()
+	if (dirty & (ParameterSnapshot::backendGroup | ParameterSnapshot::oversamplingGroup | ParameterSnapshot::saturationGroup)) {
+		auto latency = strip.getLatencyInSamples();
 
-	((LowShelfProcessor*)lowShelfNode.get()->getProcessor())
-		->updateSettings(sampleRateX, smoothLowFreq.getNextValue(), smoothLowQ.getNextValue(), smoothLowGain.getNextValue());
+		if (latency != latencySamples.exchange(latency))
+			triggerAsyncUpdate();
+	}
 
-	smoothLowFreq.skip(getBlockSize() - 1);
-	smoothLowQ.skip(getBlockSize() - 1);
-	smoothLowGain.skip(getBlockSize() - 1);
+	strip.beginControlInterval(numSamples);
+	tailSeconds = strip.getTailInSamples() / sampleRateX;
 
-	//-------------------------------------------------------------
-	//-------------------------------------------------------------
-	auto lowMidFreq = (apvts.getRawParameterValue("LOWMIDFREQ"))->load();
-	smoothLowMidFreq.setTargetValue(lowMidFreq);
+	publishCoefficients();
+}
+
+void J13AudioProcessor::publishCoefficients()
+{
+	CoefficientSnapshot::Coefficients coefficients;
 
-	auto lowMidQ = (apvts.getRawParameterValue("LOWMIDQ"))->load();
-	if (lowMidQ < 0.1f) {
-		lowMidQ = 0.1f;
+	for (int set = 0; set < CoefficientSnapshot::numSets; ++set) {
+		for (int band = 0; band < CoefficientSnapshot::numBands; ++band) {
+			auto* raw = strip.getCoeffs(band, set == 1)->getRawCoefficients();
+			std::copy(raw, raw + CoefficientSnapshot::numCoeffs, coefficients.bands[set][band]);
+		}
 	}
-	smoothLowMidQ.setTargetValue(lowMidQ);
 
-	auto lowMidGainDb = (apvts.getRawParameterValue("LOWMIDGAIN"))->load();
-	auto lowMidGain = juce::Decibels::decibelsToGain(lowMidGainDb);
+	if (coefficients == publishedCoefficients)
+		return;
 
-	if (lowMidGain < 0.1f) {
-		lowMidGain = 0.1f;
-	}
+	publishedCoefficients = coefficients;
+	coefficientSnapshot.publish(coefficients);
+}
 
-	smoothLowMidGain.setTargetValue(lowMidGain);
+void J13AudioProcessor::updateDynamics()
+{
+	using P = ParameterSnapshot;
 
-	((PeakProcessor*)lowMidPeakNode.get()->getProcessor())
-		->updateSettings(
-			sampleRateX, smoothLowMidFreq.getNextValue(), smoothLowMidQ.getNextValue(), smoothLowMidGain.getNextValue());
+	static constexpr P::Param firstParams[ChannelStrip::numDynamicBands] = { P::lowMidDynamic, P::highMidDynamic };
 
-	smoothLowMidFreq.skip(getBlockSize() - 1);
-	smoothLowMidQ.skip(getBlockSize() - 1);
-	smoothLowMidGain.skip(getBlockSize() - 1);
+	for (int index = 0; index < ChannelStrip::numDynamicBands; ++index) {
+		auto first = firstParams[index];
 
-	//-------------------------------------------------------------
-	//-------------------------------------------------------------
-	auto highMidFreq = (apvts.getRawParameterValue("HIGHMIDFREQ"))->load();
-	smoothHighMidFreq.setTargetValue(highMidFreq);
+		DynamicSettings settings;
+		settings.enabled = snapshot.isOn(first);
+		settings.threshold = snapshot.get((P::Param)(first + 1));
+		settings.ratio = snapshot.get((P::Param)(first + 2));
+		settings.attack = snapshot.get((P::Param)(first + 3));
+		settings.release = snapshot.get((P::Param)(first + 4));
 
-	auto highMidQ = (apvts.getRawParameterValue("HIGHMIDQ"))->load();
-	if (highMidQ < 0.1f) {
-		highMidQ = 0.1f;
+		strip.setDynamics(ChannelStrip::dynamicBands[index], settings);
 	}
-	smoothHighMidQ.setTargetValue(highMidQ);
+}
+
+// Follows the saturation buttons of one set of stages, 0 primary or 1 side
+void J13AudioProcessor::updateSaturation(int set)
+{
+	auto& stages = set == 0 ? strip.primary : strip.side;
+	auto param = [set](ParameterSnapshot::Param p) { return set == 0 ? p : ParameterSnapshot::sideOf(p); };
 
-	auto highMidGainDb = (apvts.getRawParameterValue("HIGHMIDGAIN"))->load();
-	auto highMidGain = juce::Decibels::decibelsToGain(highMidGainDb);
+	stages.inSaturation.setUseTables(snapshot.isOn(ParameterSnapshot::lookupTables));
+	stages.outSaturation.setUseTables(snapshot.isOn(ParameterSnapshot::lookupTables));
 
-	if (highMidGain < 0.1f) {
-		highMidGain = 0.1f;
+	if (snapshot.isOn(param(ParameterSnapshot::inClean))) {
+		stages.inSaturation.setSaturationType(SaturationProcessor::clean);
+	} else if (snapshot.isOn(param(ParameterSnapshot::inWarm))) {
+		stages.inSaturation.setSaturationType(SaturationProcessor::warm);
+	} else {
+		stages.inSaturation.setSaturationType(SaturationProcessor::bright);
 	}
 
-	smoothHighMidGain.setTargetValue(highMidGain);
-
-	((PeakProcessor*)highMidPeakNode.get()->getProcessor())
-		->updateSettings(
-			sampleRateX, smoothHighMidFreq.getNextValue(), smoothHighMidQ.getNextValue(), smoothHighMidGain.getNextValue());
+	if (snapshot.isOn(param(ParameterSnapshot::outClean))) {
+		stages.outSaturation.setSaturationType(SaturationProcessor::clean);
+	} else if (snapshot.isOn(param(ParameterSnapshot::outWarm))) {
+		stages.outSaturation.setSaturationType(SaturationProcessor::warm);
+	} else {
+		stages.outSaturation.setSaturationType(SaturationProcessor::thick);
+	}
+}
 
-	smoothHighMidFreq.skip(getBlockSize() - 1);
-	smoothHighMidQ.skip(getBlockSize() - 1);
-	smoothHighMidGain.skip(getBlockSize() - 1);
+// Follows the band parameters of one set of stages, 0 primary or 1 side
+void J13AudioProcessor::updateBands(int set, juce::uint32 dirty, int skipSize)
+{
+	auto& smoothers = bandSmoothers[set];
+	auto& stages = set == 0 ? strip.primary : strip.side;
+	auto param = [set](ParameterSnapshot::Param p) { return set == 0 ? p : ParameterSnapshot::sideOf(p); };
 
 	//-------------------------------------------------------------
-	//-------------------------------------------------------------
-	auto highfreq = (apvts.getRawParameterValue("HIGHFREQ"))->load();
-	smoothHighFreq.setTargetValue(highfreq);
+	if ((dirty & ParameterSnapshot::lowGroup) || smoothers.lowFreq.isSmoothing() || smoothers.lowQ.isSmoothing()
+		|| smoothers.lowGain.isSmoothing()) {
+		smoothers.lowFreq.setTargetValue(snapshot.get(param(ParameterSnapshot::lowFreq)));
 
-	// auto highShelf = (apvts.getRawParameterValue("HIGHSHELF"))->load();
-	auto highBump = (apvts.getRawParameterValue("HIGHBUMP"))->load();
-	auto highWide = (apvts.getRawParameterValue("HIGHWIDE"))->load();
+		auto lowgain = juce::Decibels::decibelsToGain(snapshot.get(param(ParameterSnapshot::lowGain)));
 
-	float highQ = 0.7f;
+		if (lowgain < 0.1f) {
+			lowgain = 0.1f;
+		}
 
-	if (highBump) {
-		highQ = 1.4f;
-	} else if (highWide) {
-		highQ = 0.4f;
-	}
+		smoothers.lowGain.setTargetValue(lowgain);
 
-	smoothHighQ.setTargetValue(highQ);
+		float lowQ;
 
-	auto highgainDb = (apvts.getRawParameterValue("HIGHGAIN"))->load();
-	auto highgain = juce::Decibels::decibelsToGain(highgainDb);
+		if (snapshot.isOn(param(ParameterSnapshot::lowBump))) {
+			if (smoothers.lowGain.getCurrentValue() > 1.0f) {
+				lowQ = 1.1f;
+			} else {
+				lowQ = 1.4f;
+			}
+		} else if (snapshot.isOn(param(ParameterSnapshot::lowWide))) {
+			lowQ = 0.4f;
+		} else {
+			lowQ = 0.7f;
+		}
 
-	if (highgain < 0.1f) {
-		highgain = 0.1f;
+		smoothers.lowQ.setTargetValue(lowQ);
+
+		stages.lowShelf.updateSettings(
+			sampleRateX, smoothers.lowFreq.getNextValue(), smoothers.lowQ.getNextValue(), smoothers.lowGain.getNextValue());
+
+		smoothers.lowFreq.skip(skipSize);
+		smoothers.lowQ.skip(skipSize);
+		smoothers.lowGain.skip(skipSize);
 	}
 
-	smoothHighGain.setTargetValue(highgain);
+	//-------------------------------------------------------------
+	//-------------------------------------------------------------
+	if ((dirty & ParameterSnapshot::lowMidGroup) || smoothers.lowMidFreq.isSmoothing() || smoothers.lowMidQ.isSmoothing()
+		|| smoothers.lowMidGain.isSmoothing()) {
+		smoothers.lowMidFreq.setTargetValue(snapshot.get(param(ParameterSnapshot::lowMidFreq)));
+
+		auto lowMidQ = snapshot.get(param(ParameterSnapshot::lowMidQ));
+		if (lowMidQ < 0.1f) {
+			lowMidQ = 0.1f;
+		}
+		smoothers.lowMidQ.setTargetValue(lowMidQ);
+
+		auto lowMidGain = juce::Decibels::decibelsToGain(snapshot.get(param(ParameterSnapshot::lowMidGain)));
 
-	((HighShelfProcessor*)highShelfNode.get()->getProcessor())
-		->updateSettings(sampleRateX, smoothHighFreq.getNextValue(), smoothHighQ.getNextValue(), smoothHighGain.getNextValue());
+		if (lowMidGain < 0.1f) {
+			lowMidGain = 0.1f;
+		}
 
-	smoothHighFreq.skip(getBlockSize() - 1);
-	smoothHighQ.skip(getBlockSize() - 1);
-	smoothHighGain.skip(getBlockSize() - 1);
+		smoothers.lowMidGain.setTargetValue(lowMidGain);
 
+		stages.lowMidPeak.updateSettings(sampleRateX, smoothers.lowMidFreq.getNextValue(), smoothers.lowMidQ.getNextValue(),
+			smoothers.lowMidGain.getNextValue());
 
-	// auto x = ((HighShelfProcessor*)highShelfNode.get()->getProcessor());
-	// auto y = x->getBypassParameter();
+		smoothers.lowMidFreq.skip(skipSize);
+		smoothers.lowMidQ.skip(skipSize);
+		smoothers.lowMidGain.skip(skipSize);
+	}
 
 	//-------------------------------------------------------------
 	//-------------------------------------------------------------
-	auto highPassFreq = (apvts.getRawParameterValue("HIGHPASS"))->load();
-	smoothHighPass.setTargetValue(highPassFreq);
+	if ((dirty & ParameterSnapshot::highMidGroup) || smoothers.highMidFreq.isSmoothing() || smoothers.highMidQ.isSmoothing()
+		|| smoothers.highMidGain.isSmoothing()) {
+		smoothers.highMidFreq.setTargetValue(snapshot.get(param(ParameterSnapshot::highMidFreq)));
 
-	((HighPassProcessor*)highPassNode.get()->getProcessor())->updateSettings(sampleRateX, smoothHighPass.getNextValue());
+		auto highMidQ = snapshot.get(param(ParameterSnapshot::highMidQ));
+		if (highMidQ < 0.1f) {
+			highMidQ = 0.1f;
+		}
+		smoothers.highMidQ.setTargetValue(highMidQ);
 
-	smoothHighPass.skip(getBlockSize() - 1);
-}
+		auto highMidGain = juce::Decibels::decibelsToGain(snapshot.get(param(ParameterSnapshot::highMidGain)));
 
-juce::dsp::IIR::Coefficients<float>* J13AudioProcessor::getCoeffs(int filterNum)
-{
-	juce::AudioProcessorGraph::Node* node;
-	if (filterNum == 0) {
-		node = lowShelfNode.get();
-	} else if (filterNum == 1) {
-		node = lowMidPeakNode.get();
-	} else if (filterNum == 2) {
-		node = highMidPeakNode.get();
-	} else if (filterNum == 3) {
-		node = highShelfNode.get();
-	} else if (filterNum == 4) {
-		node = highPassNode.get();
-	} else {
-		return nullptr;
-	}
+		if (highMidGain < 0.1f) {
+			highMidGain = 0.1f;
+		}
 
-	if (node == nullptr) {
-		return nullptr;
-	}
+		smoothers.highMidGain.setTargetValue(highMidGain);
 
-	auto proc = node->getProcessor();
-
-	if (filterNum == 0) {
-		return ((LowShelfProcessor*)proc)->getCoeffs();
-	} else if (filterNum == 1) {
-		return ((PeakProcessor*)proc)->getCoeffs();
-	} else if (filterNum == 2) {
-		return ((PeakProcessor*)proc)->getCoeffs();
-	} else if (filterNum == 3) {
-		return ((HighShelfProcessor*)proc)->getCoeffs();
-	} else if (filterNum == 4) {
-		return ((HighPassProcessor*)proc)->getCoeffs();
-	}
+		stages.highMidPeak.updateSettings(sampleRateX, smoothers.highMidFreq.getNextValue(), smoothers.highMidQ.getNextValue(),
+			smoothers.highMidGain.getNextValue());
 
-	return nullptr;
-}
+		smoothers.highMidFreq.skip(skipSize);
+		smoothers.highMidQ.skip(skipSize);
+		smoothers.highMidGain.skip(skipSize);
+	}
 
-void J13AudioProcessor::connectAudioNodes()
-{
-	for (int channel = 0; channel < 2; ++channel) {
-		mainProcessor->addConnection({ { audioInputNode->nodeID, channel }, { inputGainNode->nodeID, channel } });
+	//-------------------------------------------------------------
+	//-------------------------------------------------------------
+	if ((dirty & ParameterSnapshot::highGroup) || smoothers.highFreq.isSmoothing() || smoothers.highQ.isSmoothing()
+		|| smoothers.highGain.isSmoothing()) {
+		smoothers.highFreq.setTargetValue(snapshot.get(param(ParameterSnapshot::highFreq)));
 
-		mainProcessor->addConnection({ { inputGainNode->nodeID, channel }, { inSaturationNode->nodeID, channel } });
+		float highQ = 0.7f;
 
-		mainProcessor->addConnection({ { inSaturationNode->nodeID, channel }, { lowShelfNode->nodeID, channel } });
+		if (snapshot.isOn(param(ParameterSnapshot::highBump))) {
+			highQ = 1.4f;
+		} else if (snapshot.isOn(param(ParameterSnapshot::highWide))) {
+			highQ = 0.4f;
+		}
 
-		mainProcessor->addConnection({ { lowShelfNode->nodeID, channel }, { lowMidPeakNode->nodeID, channel } });
+		smoothers.highQ.setTargetValue(highQ);
 
-		mainProcessor->addConnection({ { lowMidPeakNode->nodeID, channel }, { driveNode->nodeID, channel } });
+		auto highgain = juce::Decibels::decibelsToGain(snapshot.get(param(ParameterSnapshot::highGain)));
 
-		mainProcessor->addConnection({ { driveNode->nodeID, channel }, { highMidPeakNode->nodeID, channel } });
+		if (highgain < 0.1f) {
+			highgain = 0.1f;
+		}
 
-		mainProcessor->addConnection({ { highMidPeakNode->nodeID, channel }, { highShelfNode->nodeID, channel } });
+		smoothers.highGain.setTargetValue(highgain);
 
-		mainProcessor->addConnection({ { highShelfNode->nodeID, channel }, { outSaturationNode->nodeID, channel } });
+		stages.highShelf.updateSettings(
+			sampleRateX, smoothers.highFreq.getNextValue(), smoothers.highQ.getNextValue(), smoothers.highGain.getNextValue());
 
-		mainProcessor->addConnection({ { outSaturationNode->nodeID, channel }, { outputGainNode->nodeID, channel } });
+		smoothers.highFreq.skip(skipSize);
+		smoothers.highQ.skip(skipSize);
+		smoothers.highGain.skip(skipSize);
+	}
 
-		mainProcessor->addConnection({ { outputGainNode->nodeID, channel }, { driveOffsetNode->nodeID, channel } });
+	//-------------------------------------------------------------
+	//-------------------------------------------------------------
+	if ((dirty & ParameterSnapshot::highPassGroup) || smoothers.highPass.isSmoothing()) {
+		smoothers.highPass.setTargetValue(snapshot.get(param(ParameterSnapshot::highPass)));
 
-		mainProcessor->addConnection({ { driveOffsetNode->nodeID, channel }, { highPassNode->nodeID, channel } });
+		stages.highPass.updateSettings(sampleRateX, smoothers.highPass.getNextValue());
 
-		mainProcessor->addConnection({ { highPassNode->nodeID, channel }, { audioOutputNode->nodeID, channel } });
+		smoothers.highPass.skip(skipSize);
 	}
 }
 
-void J13AudioProcessor::connectMidiNodes()
+void J13AudioProcessor::BandSmoothers::reset(double sampleRate, double rampLengthInSeconds)
 {
-	mainProcessor->addConnection({ { midiInputNode->nodeID, juce::AudioProcessorGraph::midiChannelIndex },
-		{ midiOutputNode->nodeID, juce::AudioProcessorGraph::midiChannelIndex } });
-}
\ No newline at end of file
+	for (auto* smoother : { &lowFreq, &lowQ, &lowGain, &lowMidFreq, &lowMidQ, &lowMidGain, &highMidFreq, &highMidQ,
+			 &highMidGain, &highFreq, &highQ, &highGain })
+		smoother->reset(sampleRate, rampLengthInSeconds);
+}
+
+void J13AudioProcessor::BandSmoothers::snapToTargets()
+{
+	for (auto* smoother : { &highPass, &lowFreq, &lowQ, &lowGain, &lowMidFreq, &lowMidQ, &lowMidGain, &highMidFreq,
+			 &highMidQ, &highMidGain, &highFreq, &highQ, &highGain })
+		smoother->setCurrentAndTargetValue(smoother->getTargetValue());
+}
@@ -12,10 +12,12 @@
 
 #include <JuceHeader.h>
 
-using AudioGraphIOProcessor = juce::AudioProcessorGraph::AudioGraphIOProcessor;
-using Node = juce::AudioProcessorGraph::Node;
+#include "ChannelStrip.h"
+#include "CoefficientSnapshot.h"
+#include "ParameterSnapshot.h"
+#include "StageTimer.h"
 
-class J13AudioProcessor : public juce::AudioProcessor
+class J13AudioProcessor : public juce::AudioProcessor, private juce::AsyncUpdater
 
 {
 public:
@@ -23,9 +25,11 @@ public:
 	~J13AudioProcessor() override;
 
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
-	void releaseResources() override { mainProcessor->releaseResources(); }
+	void releaseResources() override { }
 	bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
-	void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&);
+	void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+	void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+	bool supportsDoublePrecisionProcessing() const override { return true; }
 
 	juce::AudioProcessorEditor* createEditor() override;
 	bool hasEditor() const override { return true; }
@@ -36,7 +40,8 @@ public:
 	bool producesMidi() const override { return false; }
 	bool isMidiEffect() const override { return false; }
 
-	double getTailLengthSeconds() const override { return 0.0; }
+	// Follows the band settings, see ChannelStrip::getTailInSamples()
+	double getTailLengthSeconds() const override { return tailSeconds.load(); }
 
 	int getNumPrograms() override { return 1; }
 	int getCurrentProgram() override { return 0; }
@@ -49,40 +54,82 @@ public:
 
 	juce::AudioProcessorValueTreeState apvts;
 
-	juce::dsp::IIR::Coefficients<float>* getCoeffs(int filterNum);
+	// The band coefficients for display, published by the audio thread
+	const CoefficientSnapshot& getCoefficientSnapshot() const { return coefficientSnapshot; }
 
-private:
-	int count = 0;
+	// How often, in samples, smoothers advance and bands are redesigned. 0
+	// updates once per host block instead. Any thread; it takes effect at the
+	// next control tick.
+	static constexpr int defaultControlInterval = 32;
+	void setControlInterval(int numSamples) { controlInterval = juce::jmax(0, numSamples); }
+	int getControlInterval() const { return controlInterval.load(); }
+
+	// Frames run through the whole chain at a time, see ChannelStrip::setTileSize()
+	void setTileSize(int numFrames) { strip.setTileSize(numFrames); }
+	int getTileSize() const { return strip.getTileSize(); }
+
+	// Plays a user curve from SaturationTables::getUserCurveFolder() in place of
+	// the input (0) or output (1) saturation type; Clean still bypasses it. An
+	// empty name goes back to the built in curves. Saved with the state. Call
+	// on the message thread.
+	void setUserCurve(int stage, const juce::String& name);
+	juce::String getUserCurve(int stage) const;
+	juce::StringArray getUserCurveNames() const { return saturationTables->getUserCurveNames(); }
+
+	// Per block and per stage DSP timings. Block, control and chain always
+	// run; enable them for the rest, e.g. while the editor shows them.
+	StageTimers& getStageTimers() { return stageTimers; }
 
+private:
 	juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
-	void updateGain(juce::StringRef ParameterID, juce::SmoothedValue<float>* smoother, Node::Ptr node);
 
-	std::unique_ptr<juce::AudioProcessorGraph> mainProcessor;
+	// True for the parameters that get a "SIDE" copy for mid/side mode
+	static bool isSideParameter(const juce::String& paramID);
+
+	ParameterSnapshot snapshot;
+	ChannelStrip strip;
+
+	juce::SharedResourcePointer<SaturationTables> saturationTables;
+	std::atomic<const SaturationCurve*> userCurves[2] { nullptr, nullptr };
+	static constexpr const char* userCurveIds[2] = { "INCURVE", "OUTCURVE" };
 
-	Node::Ptr audioInputNode;
-	Node::Ptr audioOutputNode;
-	Node::Ptr midiInputNode;
-	Node::Ptr midiOutputNode;
+	juce::uint32 pendingGroups = 0;
 
-	Node::Ptr inputGainNode;
-	Node::Ptr driveNode;
-	Node::Ptr driveOffsetNode;
-	Node::Ptr outputGainNode;
+	std::atomic<int> controlInterval { defaultControlInterval };
+	int samplesToNextControl = 0;
 
-	Node::Ptr highPassNode;
-	Node::Ptr highShelfNode;
-	Node::Ptr lowShelfNode;
+	// Input at or below this peak level counts as silence, -120 dBFS
+	static constexpr double silenceThreshold = 1.0e-6;
+	juce::int64 silentSamples = 0;
+	bool idling = false;
+	std::atomic<double> tailSeconds { 0.0 };
 
-	Node::Ptr highMidPeakNode;
-	Node::Ptr lowMidPeakNode;
+	// Set by the audio thread when the strip's latency changes and passed to
+	// setLatencySamples() on the message thread, see handleAsyncUpdate()
+	std::atomic<int> latencySamples { 0 };
+	void handleAsyncUpdate() override { setLatencySamples(latencySamples.load()); }
 
-	Node::Ptr inSaturationNode;
-	Node::Ptr outSaturationNode;
+	// The stages are probed one by one about this often while the timers are enabled
+	static constexpr double probeSeconds = 0.1;
+	StageTimers stageTimers;
+	int samplesToNextProbe = 0;
 
-	void initialiseGraph();
-	void updateGraph();
-	void connectAudioNodes();
-	void connectMidiNodes();
+	// Only published when a band was redesigned
+	CoefficientSnapshot coefficientSnapshot;
+	CoefficientSnapshot::Coefficients publishedCoefficients {};
+
+	void updateGraph(int numSamples);
+	void publishCoefficients();
+	void updateDynamics();
+	void updateSaturation(int set);
+	void updateBands(int set, juce::uint32 dirty, int skipSize);
+
+	// Both processBlock() overloads, float or double all the way through the strip
+	template <typename SampleType>
+	void processSamples(juce::AudioBuffer<SampleType>& buffer);
+
+	// The bus the dynamic peaks can listen to instead of their own band
+	static constexpr int keyBus = 1;
 
 	double sampleRateX;
 
@@ -90,23 +137,34 @@ private:
 	juce::SmoothedValue<float> smoothDrive { 1.0f };
 	juce::SmoothedValue<float> smoothOutGain { 1.0f };
 
-	juce::SmoothedValue<float> smoothHighPass { 1.0f };
+	// The band smoothers for one set of stages: 0 primary, 1 side
+	struct BandSmoothers {
+		juce::SmoothedValue<float> highPass { 1.0f };
+
+		juce::SmoothedValue<float> lowFreq { 100.0f };
+		juce::SmoothedValue<float> lowQ { 0.7f };
+		juce::SmoothedValue<float> lowGain { 1.0f };
+
+		juce::SmoothedValue<float> lowMidFreq { 100.0f };
+		juce::SmoothedValue<float> lowMidQ { 0.7f };
+		juce::SmoothedValue<float> lowMidGain { 1.0f };
+
+		juce::SmoothedValue<float> highMidFreq { 4000.0f };
+		juce::SmoothedValue<float> highMidQ { 0.7f };
+		juce::SmoothedValue<float> highMidGain { 1.0f };
 
-	juce::SmoothedValue<float> smoothLowFreq { 100.0f };
-	juce::SmoothedValue<float> smoothLowQ { 0.7f };
-	juce::SmoothedValue<float> smoothLowGain { 1.0f };
+		juce::SmoothedValue<float> highFreq { 4000.0f };
+		juce::SmoothedValue<float> highQ { 0.7f };
+		juce::SmoothedValue<float> highGain { 1.0f };
 
-	juce::SmoothedValue<float> smoothLowMidFreq { 100.0f };
-	juce::SmoothedValue<float> smoothLowMidQ { 0.7f };
-	juce::SmoothedValue<float> smoothLowMidGain { 1.0f };
+		// All but the high pass, which follows its parameter directly
+		void reset(double sampleRate, double rampLengthInSeconds);
 
-	juce::SmoothedValue<float> smoothHighMidFreq { 4000.0f };
-	juce::SmoothedValue<float> smoothHighMidQ { 0.7f };
-	juce::SmoothedValue<float> smoothHighMidGain { 1.0f };
+		// Ends every ramp on its target
+		void snapToTargets();
+	};
 
-	juce::SmoothedValue<float> smoothHighFreq { 4000.0f };
-	juce::SmoothedValue<float> smoothHighQ { 0.7f };
-	juce::SmoothedValue<float> smoothHighGain { 1.0f };
+	BandSmoothers bandSmoothers[2];
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(J13AudioProcessor)
 };
\ No newline at end of file
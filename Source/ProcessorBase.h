@@ -1,47 +0,0 @@
-/*
-  ==============================================================================
-
-    ProcessorBase.h
-    Created: 22 Jan 2023 10:41:29am
-    Author:  jkokosa
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-class ProcessorBase : public juce::AudioProcessor {
-public:
-	ProcessorBase()
-		: AudioProcessor(BusesProperties()
-							 .withInput("Input", juce::AudioChannelSet::stereo())
-							 .withOutput("Output", juce::AudioChannelSet::stereo()))
-	{
-	}
-
-	void prepareToPlay(double, int) override { }
-	void releaseResources() override { }
-	void processBlock(juce::AudioSampleBuffer&, juce::MidiBuffer&) override { }
-
-	juce::AudioProcessorEditor* createEditor() override { return nullptr; }
-	bool hasEditor() const override { return false; }
-
-	const juce::String getName() const override { return {}; }
-	bool acceptsMidi() const override { return false; }
-	bool producesMidi() const override { return false; }
-	double getTailLengthSeconds() const override { return 0; }
-
-	int getNumPrograms() override { return 0; }
-	int getCurrentProgram() override { return 0; }
-	void setCurrentProgram(int) override { }
-	const juce::String getProgramName(int) override { return {}; }
-	void changeProgramName(int, const juce::String&) override { }
-
-	void getStateInformation(juce::MemoryBlock&) override { }
-	void setStateInformation(const void*, int) override { }
-
-private:
-	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessorBase)
-};
\ No newline at end of file
@@ -10,86 +10,336 @@
 
 #pragma once
 
-#include "ProcessorBase.h"
 #include <JuceHeader.h>
 
-class SaturationProcessor : public ProcessorBase {
+#include "Antiderivatives.h"
+#include "CurveTable.h"
+#include "FastMath.h"
+
+//==============================================================================
+// One saturation character as data: the curve as a cubic lookup table for
+// direct use, and its antiderivatives for ADAA
+struct SaturationCurve {
+	// Table range and size: 16 cells per unit over +-32, 16 kB per curve
+	static constexpr double tableRange = 32.0;
+	static constexpr int tableCells = 1024;
+
+	template <typename Curve>
+	SaturationCurve(const juce::String& curveName, Curve curve, double asymptoticSlope)
+		: name(curveName)
+		, table(curve, tableRange, tableCells, asymptoticSlope)
+		, antiderivatives(curve, asymptoticSlope)
+	{
+	}
+
+	// A user curve, mapped from a .j13curve file
+	explicit SaturationCurve(const juce::File& file)
+		: name(file.getFileNameWithoutExtension())
+		, table(file)
+		, antiderivatives([this](double x) { return table.isValid() ? table.evaluate(x) : x; }, table.getAsymptoticSlope())
+	{
+	}
+
+	juce::String name;
+	CurveTable table;
+	AntiderivativeTable antiderivatives;
+};
+
+//==============================================================================
+// The built in curves and any user curves, built once and shared read-only by
+// every instance in the process through juce::SharedResourcePointer. User
+// curves are the .j13curve files in getUserCurveFolder() when the first
+// instance is created; their cells stay memory-mapped rather than copied.
+class SaturationTables {
 public:
-	SaturationProcessor() { }
+	SaturationTables();
 
-	const juce::String getName() const override { return "SaturationFilter"; }
+	const SaturationCurve& getBuiltIn(int saturationType) const { return *builtIn[saturationType]; }
 
-	void prepareToPlay(double sampleRate, int samplesPerBlock) override
+	const SaturationCurve* findUserCurve(const juce::String& name) const
 	{
-		SaturationProcessor::saveSamplesPerBlock = samplesPerBlock;
+		for (auto* curve : user)
+			if (curve->name == name)
+				return curve;
+
+		return nullptr;
 	}
 
-	void processBlock(juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
+	juce::StringArray getUserCurveNames() const
 	{
-		juce::ScopedNoDenormals noDenormals;
-		auto totalNumInputChannels = getTotalNumInputChannels();
-		auto totalNumOutputChannels = getTotalNumOutputChannels();
+		juce::StringArray names;
 
-		setFunction();
+		for (auto* curve : user)
+			names.add(curve->name);
 
-		// In case we have more outputs than inputs, this code clears any output
-		// channels that didn't contain input data, (because these aren't
-		for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-			buffer.clear(i, 0, buffer.getNumSamples());
+		return names;
+	}
 
-		// This is the place where you'd normally do the guts of your plugin's
-		// audio processing...
-		for (int channel = 0; channel < totalNumInputChannels; ++channel) {
-			auto* channelData = buffer.getWritePointer(channel);
+	static juce::File getUserCurveFolder()
+	{
+		return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+			.getChildFile("j13")
+			.getChildFile("Curves");
+	}
 
-			for (int sampleNum = 0; sampleNum < saveSamplesPerBlock; ++sampleNum) {
-				float x = channelData[sampleNum];
-				channelData[sampleNum] = fn(x);
-			}
+private:
+	juce::OwnedArray<SaturationCurve> builtIn, user;
+
+	JUCE_DECLARE_NON_COPYABLE(SaturationTables)
+};
+
+//==============================================================================
+// The curves are templates on the lane type, so ChannelStrip runs them on a
+// whole sample frame at once. beginBlock() latches the type for the block;
+// the switch in process() then always takes the same, inlined, branch.
+//
+// With lookup tables on, or with a user curve set, the curve is read from
+// its shared CurveTable instead of being computed.
+//
+// With antialiasing on, the curves are instead applied by first or second
+// order ADAA, worked out lane by lane in double from the shared tables of
+// antiderivatives. This delays the signal by half a sample per order.
+class SaturationProcessor {
+public:
+	enum SaturationType { clean = 0, warm = 1, bright = 2, thick = 3 };
+	enum Antialiasing { noAntialiasing = 0, firstOrderAdaa = 1, secondOrderAdaa = 2 };
+
+	// Pick the curve for the coming block, call before process(). Without
+	// antialiasing the block runs without ADAA, and without its delay.
+	void beginBlock(bool withAntialiasing = true)
+	{
+		auto antialiasing = withAntialiasing ? activeAntialiasing : noAntialiasing;
+
+		if (antialiasing != blockAntialiasing)
+			reset();
+
+		blockType = activeType;
+		blockAntialiasing = antialiasing;
+		blockCurve = userCurve != nullptr ? userCurve : &tables->getBuiltIn(activeType);
+		blockTable = userCurve != nullptr || (useTables && activeType != clean) ? &blockCurve->table : nullptr;
+		blockLinear = isLinear();
+	}
+
+	// Clears the ADAA history
+	void reset()
+	{
+		for (auto& samples : history)
+			std::fill(samples, samples + maxLanes, 0.0);
+	}
+
+	template <typename Lanes>
+	Lanes process(Lanes x) noexcept
+	{
+		if (blockAntialiasing != noAntialiasing)
+			return processAntialiased(x);
+
+		if (blockTable != nullptr)
+			return blockTable->process(x);
+
+		switch (blockType) {
+		case warm:
+			return shape<warm>(x);
+		case bright:
+			return shape<bright>(x);
+		case thick:
+			return shape<thick>(x);
+		default:
+			return x;
 		}
 	}
 
-	void reset() override { }
+	// possible functions, needs tested/tweaked
+	template <SaturationType type, typename Lanes>
+	static Lanes shape(Lanes x) noexcept
+	{
+		if constexpr (type == warm) {
+			// 0.5 tanh(2 (a + b) / M) + (a + b + x) / M with M = 2
+			auto ab = Lanes::expand(0.2f) * FastMath::tanh(x) + Lanes::expand(0.3f) * FastMath::sin(x);
+			return Lanes::expand(0.5f) * (FastMath::tanh(ab) + ab + x);
+		} else if constexpr (type == bright) {
+			// tanh(x) above zero, 0.8 tanh(x) below, plus a quarter of the dry signal
+			auto t = FastMath::tanh(x);
+			return Lanes::expand(0.9f) * t + Lanes::expand(0.1f) * FastMath::abs(t) + Lanes::expand(0.25f) * x;
+		} else if constexpr (type == thick) {
+			return FastMath::tanh(x);
+		} else {
+			return x;
+		}
+	}
 
-	enum SaturationType { clean = 0, warm = 1, bright = 2, thick = 3 };
+	// The curves in double, used to build the shared tables
+	static double evaluate(SaturationType type, double x) noexcept
+	{
+		switch (type) {
+		case warm: {
+			auto ab = 0.2 * std::tanh(x) + 0.3 * std::sin(x);
+			return 0.5 * (std::tanh(ab) + ab + x);
+		}
+		case bright: {
+			auto t = std::tanh(x);
+			return 0.9 * t + 0.1 * std::abs(t) + 0.25 * x;
+		}
+		case thick:
+			return std::tanh(x);
+		default:
+			return x;
+		}
+	}
 
 	void setSaturationType(SaturationType sType) { activeType = sType; }
 
 	SaturationType getSaturationType() { return activeType; }
 
+	void setAntialiasing(Antialiasing newAntialiasing) { activeAntialiasing = newAntialiasing; }
+
+	Antialiasing getAntialiasing() const noexcept { return activeAntialiasing; }
+
+	// Read the built in curves from their lookup tables
+	void setUseTables(bool shouldUseTables) { useTables = shouldUseTables; }
+
+	bool isUsingTables() const noexcept { return useTables; }
+
+	// A user curve from SaturationTables replaces the type, nullptr goes back to it
+	void setUserCurve(const SaturationCurve* newUserCurve) { userCurve = newUserCurve; }
+
+	const SaturationCurve* getUserCurve() const noexcept { return userCurve; }
+
+	// The clean curve with no user curve, a straight line that ADAA would only smear
+	bool isLinear() const noexcept { return userCurve == nullptr && activeType == clean; }
+
+	// Takes the settings of another instance but keeps this one's ADAA history
+	void followSettings(const SaturationProcessor& other) noexcept
+	{
+		activeType = other.activeType;
+		activeAntialiasing = other.activeAntialiasing;
+		useTables = other.useTables;
+		userCurve = other.userCurve;
+	}
+
+	// Delay added by ADAA, in samples at the rate the curve runs at
+	double getLatencyInSamples() const noexcept { return 0.5 * (double)activeAntialiasing; }
+
+	static constexpr size_t maxLanes = 8;
+
+	// The ADAA history, so the curve can be run without disturbing it
+	struct History {
+		double samples[2][maxLanes];
+	};
+
+	History getHistory() const noexcept
+	{
+		History saved;
+		std::copy(&history[0][0], &history[0][0] + 2 * maxLanes, &saved.samples[0][0]);
+		return saved;
+	}
+
+	void setHistory(const History& saved) noexcept
+	{
+		std::copy(&saved.samples[0][0], &saved.samples[0][0] + 2 * maxLanes, &history[0][0]);
+	}
+
 private:
-	int saveSamplesPerBlock;
 	SaturationType activeType = clean;
+	SaturationType blockType = clean;
+	Antialiasing activeAntialiasing = noAntialiasing;
+	Antialiasing blockAntialiasing = noAntialiasing;
+
+	juce::SharedResourcePointer<SaturationTables> tables;
+	bool useTables = false;
+	const SaturationCurve* userCurve = nullptr;
+	const SaturationCurve* blockCurve = &tables->getBuiltIn(clean);
+	const CurveTable* blockTable = nullptr;
+	bool blockLinear = true;
+
+	// previous and the one before previous input, per lane
+	double history[2][maxLanes] {};
 
-	float (*fn)(float);
-	void setFunction()
+	template <typename Lanes>
+	Lanes processAntialiased(Lanes x) noexcept
 	{
-		// possible functions, needs tested/tweaked
-		switch (activeType) {
-		case clean:
-			fn = [](float x) { return x; };
-			break;
-		case warm:
-			fn = [](float x) {
-				auto a = 0.2f * tanhf(x);
-				auto b = 0.3f * sinf(x);
-				auto M = 2;
-
-				return 0.5f * tanhf(2 * (a + b) / M) + (a + b + x) / M;
-			};
-			break;
-		case bright:
-			fn = [](float x) {
-				if (x >= 0.0f) {
-					return tanhf(x) + (x * 0.25f);
-				} else {
-					return (0.8f * tanhf(x)) + (x * 0.25f);
-				}
-			};
-			break;
-		case thick:
-			fn = [](float x) { return tanhf(x); };
-			break;
+		static_assert(Lanes::SIMDNumElements <= maxLanes);
+
+		auto& table = blockCurve->antiderivatives;
+
+		for (size_t lane = 0; lane < Lanes::SIMDNumElements; ++lane) {
+			double x0 = x.get(lane), x1 = history[0][lane], x2 = history[1][lane];
+
+			double y;
+
+			// For the clean curve both forms reduce to moving averages
+			if (blockLinear)
+				y = blockAntialiasing == firstOrderAdaa ? 0.5 * (x0 + x1) : (x0 + x1 + x2) / 3.0;
+			else
+				y = blockAntialiasing == firstOrderAdaa ? firstOrder(table, x0, x1) : secondOrder(table, x0, x1, x2);
+
+			history[1][lane] = x1;
+			history[0][lane] = x0;
+			x.set(lane, (typename Lanes::ElementType)y);
+		}
+
+		return x;
+	}
+
+	// Below these input steps the difference quotients lose too many bits and
+	// the midpoint forms are used instead, with error of order step^2 f''
+	static constexpr double firstOrderTolerance = 1.0e-5;
+	static constexpr double secondOrderTolerance = 1.0e-3;
+
+	// (F1(x0) - F1(x1)) / (x0 - x1)
+	static double firstOrder(const AntiderivativeTable& table, double x0, double x1) noexcept
+	{
+		auto dx = x0 - x1;
+
+		if (std::abs(dx) < firstOrderTolerance)
+			return table.f(0.5 * (x0 + x1));
+
+		return (table.antiderivative1(x0) - table.antiderivative1(x1)) / dx;
+	}
+
+	// Second order form of Bilbao, Esqueda, Parker and Valimaki (2017)
+	static double secondOrder(const AntiderivativeTable& table, double x0, double x1, double x2) noexcept
+	{
+		auto dx = x0 - x2;
+
+		if (std::abs(dx) < secondOrderTolerance) {
+			auto xBar = 0.5 * (x0 + x2);
+			auto delta = xBar - x1;
+
+			if (std::abs(delta) < secondOrderTolerance)
+				return table.f(0.5 * (xBar + x1));
+
+			auto f2Quotient = (table.antiderivative2(x1) - table.antiderivative2(xBar)) / delta;
+			return (2.0 / delta) * (table.antiderivative1(xBar) + f2Quotient);
 		}
+
+		return (2.0 / dx) * (quotient(table, x0, x1) - quotient(table, x1, x2));
+	}
+
+	// (F2(a) - F2(b)) / (a - b)
+	static double quotient(const AntiderivativeTable& table, double a, double b) noexcept
+	{
+		auto d = a - b;
+
+		if (std::abs(d) < secondOrderTolerance)
+			return table.antiderivative1(0.5 * (a + b));
+
+		return (table.antiderivative2(a) - table.antiderivative2(b)) / d;
+	}
+};
+
+inline SaturationTables::SaturationTables()
+{
+	using Processor = SaturationProcessor;
+
+	builtIn.add(new SaturationCurve("Clean", [](double x) { return Processor::evaluate(Processor::clean, x); }, 1.0));
+	builtIn.add(new SaturationCurve("Warm", [](double x) { return Processor::evaluate(Processor::warm, x); }, 0.5));
+	builtIn.add(new SaturationCurve("Bright", [](double x) { return Processor::evaluate(Processor::bright, x); }, 0.25));
+	builtIn.add(new SaturationCurve("Thick", [](double x) { return Processor::evaluate(Processor::thick, x); }, 0.0));
+
+	for (auto& file : getUserCurveFolder().findChildFiles(juce::File::findFiles, false, "*.j13curve")) {
+		auto curve = std::make_unique<SaturationCurve>(file);
+
+		if (curve->table.isValid())
+			user.add(curve.release());
 	}
-};
\ No newline at end of file
+}
\ No newline at end of file
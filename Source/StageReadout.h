@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    StageReadout.h
+    Created: 17 Oct 2026 8:41:09pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "StageTimer.h"
+
+//==============================================================================
+// A small table of StageTimers over the plot: the CPU load of the block, then
+// the mean and 99th percentile of every stage in ns per sample frame. The
+// timers are enabled while it is visible, and start over when it is shown.
+class StageReadout : public juce::Component, private juce::Timer {
+public:
+	explicit StageReadout(StageTimers& stageTimers)
+		: timers(stageTimers)
+	{
+		setInterceptsMouseClicks(false, false);
+	}
+
+	~StageReadout() override { timers.setEnabled(false); }
+
+	// Rows and the width of a row, to size it with
+	static constexpr int numRows = StageTimers::numStages + 2;
+	static constexpr int rowHeight = 12;
+	static constexpr int width = 190;
+
+	void visibilityChanged() override
+	{
+		timers.setEnabled(isVisible());
+
+		if (isVisible()) {
+			timers.reset();
+			startTimer(500);
+		} else {
+			stopTimer();
+		}
+	}
+
+	void paint(juce::Graphics& g) override
+	{
+		g.setColour(juce::Colours::black.withAlpha(0.7f));
+		g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.0f);
+
+		g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+		g.setColour(juce::Colours::white);
+
+		auto area = getLocalBounds().reduced(6, 4);
+		auto block = timers.getSummary(StageTimers::block);
+
+		// ns per frame times frames per second is the share of real time
+		auto load = block.mean * timers.getSampleRate() * 1.0e-7;
+		g.drawText("CPU " + juce::String(load, 2) + " %", area.removeFromTop(rowHeight), juce::Justification::left);
+
+		drawRow(g, area.removeFromTop(rowHeight), "ns/frame", "mean", "p99");
+
+		for (int stage = 0; stage < StageTimers::numStages; ++stage) {
+			auto summary = timers.getSummary((StageTimers::Stage)stage);
+			auto row = area.removeFromTop(rowHeight);
+
+			if (summary.count == 0) {
+				drawRow(g, row, StageTimers::getName((StageTimers::Stage)stage), "-", "-");
+			} else {
+				drawRow(g, row, StageTimers::getName((StageTimers::Stage)stage), juce::String(summary.mean, 1),
+					juce::String(summary.p99, 1));
+			}
+		}
+	}
+
+private:
+	StageTimers& timers;
+
+	void timerCallback() override { repaint(); }
+
+	static void drawRow(juce::Graphics& g, juce::Rectangle<int> row, const juce::String& name, const juce::String& mean,
+		const juce::String& p99)
+	{
+		auto p99Area = row.removeFromRight(50);
+		auto meanArea = row.removeFromRight(50);
+
+		g.drawText(name, row, juce::Justification::left);
+		g.drawText(mean, meanArea, juce::Justification::right);
+		g.drawText(p99, p99Area, juce::Justification::right);
+	}
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageReadout)
+};
@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    StageTimer.h
+    Created: 17 Oct 2026 7:58:36pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Running min, mean, max and a histogram of one timed stage, in nanoseconds.
+// Only the audio thread writes, so plain relaxed loads and stores are enough;
+// a reader may see one sample half added, which a display can live with.
+//
+// The histogram has half-octave buckets from 1 ns, so percentiles come out
+// within about 20%.
+class TimingStats {
+public:
+	static constexpr int numBuckets = 64;
+
+	// Audio thread only
+	void add(double nanoseconds) noexcept
+	{
+		if (resetRequested.exchange(false, std::memory_order_acquire))
+			clear();
+
+		auto n = count.load(std::memory_order_relaxed);
+		count.store(n + 1, std::memory_order_relaxed);
+		sum.store(sum.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+
+		if (n == 0 || nanoseconds < minimum.load(std::memory_order_relaxed))
+			minimum.store(nanoseconds, std::memory_order_relaxed);
+
+		if (nanoseconds > maximum.load(std::memory_order_relaxed))
+			maximum.store(nanoseconds, std::memory_order_relaxed);
+
+		auto& bucket = buckets[getBucket(nanoseconds)];
+		bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	// Any thread; the audio thread clears the counters at its next add()
+	void requestReset() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+	struct Summary {
+		juce::uint64 count = 0;
+		double minimum = 0.0, mean = 0.0, maximum = 0.0;
+		double p50 = 0.0, p90 = 0.0, p99 = 0.0;
+	};
+
+	Summary getSummary() const noexcept
+	{
+		Summary summary;
+		summary.count = count.load(std::memory_order_relaxed);
+
+		if (summary.count == 0)
+			return summary;
+
+		summary.minimum = minimum.load(std::memory_order_relaxed);
+		summary.maximum = maximum.load(std::memory_order_relaxed);
+		summary.mean = sum.load(std::memory_order_relaxed) / (double)summary.count;
+
+		juce::uint64 histogram[numBuckets], total = 0;
+
+		for (int i = 0; i < numBuckets; ++i)
+			total += histogram[i] = buckets[i].load(std::memory_order_relaxed);
+
+		summary.p50 = getPercentile(histogram, total, 0.5);
+		summary.p90 = getPercentile(histogram, total, 0.9);
+		summary.p99 = getPercentile(histogram, total, 0.99);
+
+		return summary;
+	}
+
+private:
+	std::atomic<juce::uint64> count { 0 };
+	std::atomic<double> sum { 0.0 }, minimum { 0.0 }, maximum { 0.0 };
+	std::atomic<juce::uint64> buckets[numBuckets] {};
+	std::atomic<bool> resetRequested { false };
+
+	void clear() noexcept
+	{
+		count.store(0, std::memory_order_relaxed);
+		sum.store(0.0, std::memory_order_relaxed);
+		minimum.store(0.0, std::memory_order_relaxed);
+		maximum.store(0.0, std::memory_order_relaxed);
+
+		for (auto& bucket : buckets)
+			bucket.store(0, std::memory_order_relaxed);
+	}
+
+	static int getBucket(double nanoseconds) noexcept
+	{
+		if (nanoseconds < 1.0)
+			return 0;
+
+		return juce::jmin(numBuckets - 1, (int)(2.0 * std::log2(nanoseconds)));
+	}
+
+	// The geometric middle of the bucket the fraction falls in
+	static double getPercentile(const juce::uint64* histogram, juce::uint64 total, double fraction) noexcept
+	{
+		auto rank = (juce::uint64)std::ceil(fraction * (double)total);
+		juce::uint64 seen = 0;
+
+		for (int i = 0; i < numBuckets; ++i) {
+			seen += histogram[i];
+
+			if (seen >= rank && histogram[i] > 0)
+				return std::exp2((i + 0.5) / 2.0);
+		}
+
+		return std::exp2((numBuckets - 0.5) / 2.0);
+	}
+};
+
+//==============================================================================
+// Timings of the parts of a J13 instance, all in nanoseconds per sample frame
+// so they add up and compare directly:
+//
+//   block    the whole processBlock()
+//   control  updateGraph() and the coefficient handoff
+//   chain    ChannelStrip::process(), every stage at once
+//   linear   the linear phase FIRs, a part of chain
+//
+// and each stage on its own, from ChannelStrip::probeStages(). Block,
+// control and chain cost two clock reads per block or control tick, so they
+// always run and dump() has numbers from any session. The rest only run
+// while enabled, e.g. while the editor shows them.
+//
+// The stage numbers do not come from the audio itself. While enabled, the
+// processor replays a copy of the last tile through each stage on its own,
+// every probeSeconds (100 ms), so they show what each stage costs on that
+// signal rather than what the block cost.
+class StageTimers {
+public:
+	enum Stage {
+		block,
+		control,
+		chain,
+		linearPhaseEq,
+		inputGain,
+		inSaturation,
+		lowShelf,
+		lowMidPeak,
+		drive,
+		highMidPeak,
+		highShelf,
+		outSaturation,
+		outputGain,
+		highPass,
+		numStages
+	};
+
+	static const char* getName(Stage stage) noexcept
+	{
+		static constexpr const char* names[numStages] = { "Block", "Control", "Chain", "Linear Phase", "In Gain",
+			"In Saturation", "Low Shelf", "Low Mid", "Drive", "High Mid", "High Shelf", "Out Saturation", "Out Gain",
+			"High Pass" };
+
+		return names[stage];
+	}
+
+	// Whether a stage is timed even while the timers are not enabled
+	static constexpr bool isAlwaysTimed(Stage stage) noexcept { return stage == block || stage == control || stage == chain; }
+
+	void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+	bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+	void setSampleRate(double newSampleRate) noexcept { sampleRate.store(newSampleRate, std::memory_order_relaxed); }
+	double getSampleRate() const noexcept { return sampleRate.load(std::memory_order_relaxed); }
+
+	void add(Stage stage, double nanosecondsPerFrame) noexcept { stats[stage].add(nanosecondsPerFrame); }
+
+	// ticks from juce::Time::getHighResolutionTicks() over numFrames
+	void addTicks(Stage stage, juce::int64 ticks, int numFrames) noexcept
+	{
+		add(stage, (double)ticks * nanosecondsPerTick / (double)juce::jmax(1, numFrames));
+	}
+
+	TimingStats::Summary getSummary(Stage stage) const noexcept { return stats[stage].getSummary(); }
+
+	void reset() noexcept
+	{
+		for (auto& stage : stats)
+			stage.requestReset();
+	}
+
+	// One line per stage, for logs and bug reports
+	juce::String dump() const
+	{
+		juce::String text;
+		text << "stage, count, min, mean, max, p50, p90, p99 (ns per frame)\n";
+		text << "stages from In Gain on are replays of the last tile, see ChannelStrip::probeStages()\n";
+
+		for (int stage = 0; stage < numStages; ++stage) {
+			auto s = getSummary((Stage)stage);
+
+			text << getName((Stage)stage) << ", " << (juce::int64)s.count;
+
+			for (auto value : { s.minimum, s.mean, s.maximum, s.p50, s.p90, s.p99 })
+				text << ", " << juce::String(value, 1);
+
+			text << "\n";
+		}
+
+		return text;
+	}
+
+	//==========================================================================
+	// Times its own scope into one stage, if the stage is always timed or the
+	// timers are enabled. owner can be nullptr, which times nothing.
+	class Scope {
+	public:
+		Scope(StageTimers* owner, Stage timedStage, int framesInScope) noexcept
+			: timers(owner != nullptr && (isAlwaysTimed(timedStage) || owner->isEnabled()) ? owner : nullptr)
+			, stage(timedStage)
+			, numFrames(framesInScope)
+			, start(timers != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+		{
+		}
+
+		Scope(StageTimers& owner, Stage timedStage, int framesInScope) noexcept
+			: Scope(&owner, timedStage, framesInScope)
+		{
+		}
+
+		~Scope()
+		{
+			if (timers != nullptr)
+				timers->addTicks(stage, juce::Time::getHighResolutionTicks() - start, numFrames);
+		}
+
+	private:
+		StageTimers* timers;
+		Stage stage;
+		int numFrames;
+		juce::int64 start;
+
+		JUCE_DECLARE_NON_COPYABLE(Scope)
+	};
+
+private:
+	TimingStats stats[numStages];
+	std::atomic<bool> enabled { false };
+	std::atomic<double> sampleRate { 44100.0 };
+
+	const double nanosecondsPerTick = 1.0e9 / (double)juce::Time::getHighResolutionTicksPerSecond();
+};
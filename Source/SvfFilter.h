@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    SvfFilter.h
+    Created: 17 Oct 2026 1:48:22pm
+    Author:  jkokosa
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+#include "FastMath.h"
+
+//==============================================================================
+// Settings of one trapezoidal (TPT) state variable filter, after Andrew
+// Simper's "Linear Trapezoidal State Variable Filter" notes:
+//
+//   g = tan(pi * f / fs), k = 1 / Q
+//   out = m0 * in + m1 * band + m2 * low
+//
+// g, k and the mix gains can be changed every sample without the filter
+// blowing up, which the biquad's direct form cannot promise.
+struct SvfParameters {
+	double g = 0.0;
+	double k = 2.0;
+	double m0 = 1.0;
+	double m1 = 0.0;
+	double m2 = 0.0;
+};
+
+// The same shapes as BiquadDesign, in SVF form. gainFactor is linear gain,
+// as for the biquad designers.
+struct SvfDesign {
+	static void makeHighPass(
+		SvfParameters& p, double sampleRate, double frequency, double Q = 1.0 / juce::MathConstants<double>::sqrt2)
+	{
+		auto k = 1.0 / Q;
+
+		set(p, prewarp(sampleRate, frequency), k, 1.0, -k, -1.0);
+	}
+
+	static void makeLowShelf(SvfParameters& p, double sampleRate, double cutOffFrequency, double Q, double gainFactor)
+	{
+		auto A = juce::jmax(1.0e-6, std::sqrt(gainFactor));
+		auto k = 1.0 / Q;
+
+		set(p, prewarp(sampleRate, cutOffFrequency) / std::sqrt(A), k, 1.0, k * (A - 1.0), A * A - 1.0);
+	}
+
+	static void makeHighShelf(SvfParameters& p, double sampleRate, double cutOffFrequency, double Q, double gainFactor)
+	{
+		auto A = juce::jmax(1.0e-6, std::sqrt(gainFactor));
+		auto k = 1.0 / Q;
+
+		set(p, prewarp(sampleRate, cutOffFrequency) * std::sqrt(A), k, A * A, k * (1.0 - A) * A, 1.0 - A * A);
+	}
+
+	static void makePeakFilter(SvfParameters& p, double sampleRate, double frequency, double Q, double gainFactor)
+	{
+		auto A = juce::jmax(1.0e-6, std::sqrt(gainFactor));
+		auto k = 1.0 / (Q * A);
+
+		set(p, prewarp(sampleRate, frequency), k, 1.0, k * (A * A - 1.0), 0.0);
+	}
+
+	// The biquad with the same response, for drawing. The trapezoidal SVF is
+	// the bilinear transform of its analog prototype, so this is exact.
+	static void toBiquad(const SvfParameters& p, double* raw) noexcept
+	{
+		double g = p.g, k = p.k;
+
+		// analog numerator: m0 s^2 + (m0 k + m1) s + (m0 + m2), denominator: s^2 + k s + 1
+		auto n2 = p.m0;
+		auto n1 = p.m0 * k + p.m1;
+		auto n0 = p.m0 + p.m2;
+		auto gg = g * g;
+
+		auto a0inv = 1.0 / (1.0 + k * g + gg);
+
+		raw[0] = (n2 + n1 * g + n0 * gg) * a0inv;
+		raw[1] = 2.0 * (n0 * gg - n2) * a0inv;
+		raw[2] = (n2 - n1 * g + n0 * gg) * a0inv;
+		raw[3] = 2.0 * (gg - 1.0) * a0inv;
+		raw[4] = (1.0 - k * g + gg) * a0inv;
+	}
+
+private:
+	static double prewarp(double sampleRate, double frequency)
+	{
+		auto f = juce::jlimit(2.0, sampleRate * 0.49, frequency);
+		return std::tan(juce::MathConstants<double>::pi * f / sampleRate);
+	}
+
+	static void set(SvfParameters& p, double g, double k, double m0, double m1, double m2) noexcept
+	{
+		p.g = g;
+		p.k = k;
+		p.m0 = m0;
+		p.m1 = m1;
+		p.m2 = m2;
+	}
+};
+
+//==============================================================================
+// The five EQ bands as SVFs, laid out like BiquadCascade with every channel
+// in its own lane. New settings are reached by a linear ramp of g, k and the
+// mix gains over one control interval, so the response moves every sample
+// without any trig on the audio path.
+//
+// Only stages that are ramping pay for the a1 = 1 / (1 + g (g + k)) divide,
+// one vector divide for all lanes; a stage that has settled keeps its a1 for
+// the whole segment.
+template <typename SampleType>
+class SvfCascade {
+public:
+	using SIMDLanes = typename BiquadCascade<SampleType>::SIMDLanes;
+	using FallbackLanes = typename BiquadCascade<SampleType>::FallbackLanes;
+	static constexpr size_t numLanes = BiquadCascade<SampleType>::numLanes;
+	static constexpr int numStages = BiquadCascade<SampleType>::numStages;
+
+	SvfCascade()
+	{
+		for (int stage = 0; stage < numStages; ++stage) {
+			setTarget(stage, SvfParameters());
+			jumpToTarget(stage);
+		}
+
+		reset();
+	}
+
+	void setTarget(int stage, const SvfParameters& p)
+	{
+		const double values[] = { p.g, p.k, p.m0, p.m1, p.m2 };
+
+		for (int i = 0; i < numParams; ++i)
+			std::fill(target[stage][i], target[stage][i] + numLanes, (SampleType)values[i]);
+	}
+
+	// Target for a single lane only
+	void setTarget(int stage, const SvfParameters& p, size_t lane)
+	{
+		const double values[] = { p.g, p.k, p.m0, p.m1, p.m2 };
+
+		for (int i = 0; i < numParams; ++i)
+			target[stage][i][lane] = (SampleType)values[i];
+	}
+
+	// Start ramping every stage from where it is now to its target over numSamples
+	void beginRamp(int numSamples)
+	{
+		auto scale = (SampleType)1 / (SampleType)juce::jmax(1, numSamples);
+
+		for (int stage = 0; stage < numStages; ++stage) {
+			ramping[stage] = false;
+
+			for (int i = 0; i < numParams; ++i)
+				for (size_t lane = 0; lane < numLanes; ++lane) {
+					step[stage][i][lane] = (target[stage][i][lane] - current[stage][i][lane]) * scale;
+					ramping[stage] = ramping[stage] || step[stage][i][lane] != SampleType();
+				}
+		}
+	}
+
+	// Land on the targets exactly, so rounding in the ramps never accumulates
+	void endRamp()
+	{
+		for (int stage = 0; stage < numStages; ++stage)
+			jumpToTarget(stage);
+	}
+
+	void reset()
+	{
+		for (auto& stage : state)
+			for (auto& lanes : stage)
+				std::fill(lanes, lanes + numLanes, SampleType());
+	}
+
+	// Clears the integrators of one stage
+	void resetStage(int stage)
+	{
+		for (auto& lanes : state[stage])
+			std::fill(lanes, lanes + numLanes, SampleType());
+	}
+
+	void snapToZero() noexcept
+	{
+		for (auto& stage : state)
+			for (auto& lanes : stage)
+				for (auto& s : lanes)
+					JUCE_SNAP_TO_ZERO(s);
+	}
+
+private:
+	enum { gParam = 0, kParam, m0Param, m1Param, m2Param, numParams };
+
+public:
+	//==========================================================================
+	// Register copy for the length of one segment, see BiquadCascade::Registers
+	template <typename Lanes>
+	class Registers {
+	public:
+		explicit Registers(const SvfCascade& cascade)
+		{
+			for (int i = 0; i < numStages; ++i) {
+				auto& stage = stages[i];
+
+				for (int p = 0; p < numParams; ++p) {
+					stage.value[p] = Lanes::fromRawArray(cascade.current[i][p]);
+					stage.step[p] = Lanes::fromRawArray(cascade.step[i][p]);
+				}
+
+				stage.ramping = cascade.ramping[i];
+				stage.ic1eq = Lanes::fromRawArray(cascade.state[i][0]);
+				stage.ic2eq = Lanes::fromRawArray(cascade.state[i][1]);
+				updateA1(stage);
+			}
+		}
+
+		void store(SvfCascade& cascade) const
+		{
+			for (int i = 0; i < numStages; ++i) {
+				auto& stage = stages[i];
+
+				for (int p = 0; p < numParams; ++p)
+					stage.value[p].copyToRawArray(cascade.current[i][p]);
+
+				stage.ic1eq.copyToRawArray(cascade.state[i][0]);
+				stage.ic2eq.copyToRawArray(cascade.state[i][1]);
+			}
+		}
+
+		Lanes processStage(int stageNum, Lanes x) noexcept
+		{
+			auto& stage = stages[stageNum];
+
+			if (stage.ramping) {
+				for (int p = 0; p < numParams; ++p)
+					stage.value[p] += stage.step[p];
+
+				updateA1(stage);
+			}
+
+			auto& g = stage.value[gParam];
+			auto& a1 = stage.a1;
+
+			auto a2 = g * a1;
+			auto a3 = g * a2;
+
+			auto v3 = x - stage.ic2eq;
+			auto v1 = a1 * stage.ic1eq + a2 * v3;
+			auto v2 = stage.ic2eq + a2 * stage.ic1eq + a3 * v3;
+
+			stage.ic1eq = v1 + v1 - stage.ic1eq;
+			stage.ic2eq = v2 + v2 - stage.ic2eq;
+
+			return stage.value[m0Param] * x + stage.value[m1Param] * v1 + stage.value[m2Param] * v2;
+		}
+
+	private:
+		struct Stage {
+			Lanes value[numParams], step[numParams];
+			Lanes a1;
+			Lanes ic1eq, ic2eq;
+			bool ramping;
+		};
+
+		static void updateA1(Stage& stage) noexcept
+		{
+			const auto one = Lanes::expand((SampleType)1);
+			auto& g = stage.value[gParam];
+
+			stage.a1 = FastMath::divide(one, one + g * (g + stage.value[kParam]));
+		}
+
+		Stage stages[numStages];
+	};
+
+private:
+	alignas(32) SampleType target[numStages][numParams][numLanes];
+	alignas(32) SampleType current[numStages][numParams][numLanes];
+	alignas(32) SampleType step[numStages][numParams][numLanes];
+	alignas(32) SampleType state[numStages][2][numLanes];
+	bool ramping[numStages] {};
+
+	void jumpToTarget(int stage)
+	{
+		for (int i = 0; i < numParams; ++i) {
+			std::copy(target[stage][i], target[stage][i] + numLanes, current[stage][i]);
+			std::fill(step[stage][i], step[stage][i] + numLanes, SampleType());
+		}
+
+		ramping[stage] = false;
+	}
+};
@@ -22,6 +22,9 @@ public:
 		setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
 		setTextBoxStyle(juce::Slider::TextBoxBelow, false, 60, 18);
 
+		// jLookAndFeel draws no hover state, so only a change of value repaints the knob
+		setRepaintsOnMouseActivity(false);
+
 		label.setText(lt, juce::NotificationType::dontSendNotification);
 		label.setFont(labelFont);
 		label.setJustificationType(juce::Justification::centred);